@@ -0,0 +1,102 @@
+"""
+Generates synthetic juli programs to measure the throughput of jlc.
+
+Each scenario returns the generated files (name -> source) and the files to compile, in order.
+"""
+
+import os
+
+
+HEADER = 'C int printf(char[] s, ...);\n\n'
+
+
+def functions(n):
+    """n functions calling each other, with locals, arithmetic and branches."""
+    s = [HEADER, 'int f0(int a, int b)\n{\n  return a + b;\n}\n\n']
+    for i in range(1, n):
+        s.append('int f%d(int a, int b)\n{\n'
+                 '  int c = a * b + %d;\n'
+                 '  if (c > 100)\n  {\n    c = c - a;\n  }\n'
+                 '  return f%d(c, b);\n}\n\n' % (i, i, i - 1))
+    s.append('int main(char[][] args)\n{\n  printf("%%d\\n", f%d(1, 2));\n  return 0;\n}\n' % (n - 1))
+    return {'functions.jl': ''.join(s)}, ['functions.jl']
+
+
+def structs(n):
+    """n structs, each referring to the previous one, and a function accessing their fields."""
+    s = [HEADER, 'struct S0\n{\n  int x;\n  double y;\n}\n\n',
+         'int get0(S0 s)\n{\n  return s.x;\n}\n\n']
+    for i in range(1, n):
+        s.append('struct S%d\n{\n  int x;\n  double y;\n  S%d prev;\n}\n\n' % (i, i - 1))
+        s.append('int get%d(S%d s)\n{\n  S%d p = new S%d;\n  p.prev = s.prev;\n'
+                 '  return s.x + s.prev.x;\n}\n\n' % (i, i, i, i))
+    s.append('int main(char[][] args)\n{\n  S0 s = new S0;\n  s.x = 1;\n'
+             '  printf("%d\\n", get0(s));\n  return 0;\n}\n')
+    return {'structs.jl': ''.join(s)}, ['structs.jl']
+
+
+def nesting(n, count=10):
+    """count functions, each returning an expression nested n levels deep."""
+    ops = ['+', '*', '-']
+    e = 'a'
+    for k in range(n):
+        e = '(%s %s %d)' % (e, ops[k % len(ops)], k % 7 + 1)
+    s = [HEADER]
+    for i in range(count):
+        s.append('int nested%d(int a)\n{\n  return %s;\n}\n\n' % (i, e))
+    s.append('int main(char[][] args)\n{\n  printf("%d\\n", nested0(1));\n  return 0;\n}\n')
+    return {'nesting.jl': ''.join(s)}, ['nesting.jl']
+
+
+def overloading(n):
+    """n overloads of one function and a call of each, so every call resolves among n candidates."""
+    s = [HEADER]
+    for i in range(n):
+        s.append('struct T%d\n{\n  int v;\n}\n\n' % i)
+        s.append('int ov(T%d t)\n{\n  return t.v + %d;\n}\n\n' % (i, i))
+    s.append('int main(char[][] args)\n{\n  int sum = 0;\n')
+    for i in range(n):
+        s.append('  T%d t%d = new T%d;\n  sum = sum + ov(t%d);\n' % (i, i, i, i))
+    s.append('  printf("%d\\n", sum);\n  return 0;\n}\n')
+    return {'overloading.jl': ''.join(s)}, ['overloading.jl']
+
+
+def imports(n):
+    """n modules importing a shared base module, all imported by the main module."""
+    files = {'base.jl': HEADER + 'struct Base\n{\n  int v;\n}\n\nint base(int x)\n{\n  return x + 1;\n}\n'}
+    order = ['base.jl']
+    for i in range(n):
+        name = 'm%d.jl' % i
+        files[name] = ('import base;\n\n'
+                       'struct M%d\n{\n  Base b;\n  int v;\n}\n\n'
+                       'int fm%d(int x)\n{\n  return base(x) + %d;\n}\n' % (i, i, i))
+        order.append(name)
+    s = [HEADER]
+    for i in range(n):
+        s.append('import m%d;\n' % i)
+    s.append('\nint main(char[][] args)\n{\n  int sum = 0;\n')
+    for i in range(n):
+        s.append('  sum = sum + fm%d(%d);\n' % (i, i))
+    s.append('  printf("%d\\n", sum);\n  return 0;\n}\n')
+    files['main.jl'] = ''.join(s)
+    order.append('main.jl')
+    return files, order
+
+
+SCENARIOS = [
+    ('functions', functions, 2000),
+    ('structs', structs, 1000),
+    ('nesting', nesting, 200),
+    ('overloading', overloading, 300),
+    ('imports', imports, 100),
+]
+
+
+def write(directory, files):
+    """Writes the files and returns their total number of lines."""
+    lines = 0
+    for name, source in files.items():
+        with open(os.path.join(directory, name), 'w') as f:
+            f.write(source)
+        lines += source.count('\n')
+    return lines
@@ -0,0 +1,140 @@
+"""
+Measures the throughput of jlc on generated programs (see generate.py).
+
+For every scenario the generated sources are compiled with -ftime-report, and the lines per second of
+the parser, type checker, IR generator and emitter as well as the peak RSS of jlc are reported. With
+--save-baseline the results are stored, later runs print the change against them and fail if a
+phase got slower than --threshold.
+
+  python benchmark/run.py --jlc build/jlc [--scale 2] [--only overloading] [--parser fast] [--save-baseline]
+"""
+
+from __future__ import print_function
+
+import json
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import generate
+
+PHASES = ['parse', 'typecheck', 'irgen', 'emit']
+
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'baseline.json')
+
+
+def parse_report(report):
+    """Returns {category: {name: wall time}} from the -ftime-report output."""
+    result = {}
+    category = None
+    for line in report.splitlines():
+        if line.startswith('====='):
+            category = line.strip('= ')
+            result[category] = {}
+            continue
+        fields = line.split()
+        if category is None or len(fields) < 6:
+            continue
+        try:
+            result[category][' '.join(fields[5:])] = float(fields[0])
+        except ValueError:
+            pass
+    return result
+
+
+def measure(jlc, flags, name, generator, size):
+    directory = tempfile.mkdtemp(prefix='jlc-bench-')
+    try:
+        files, inputs = generator(size)
+        lines = generate.write(directory, files)
+        if len(inputs) == 1:
+            output = ['-o', 'out.o']
+        else:
+            os.mkdir(os.path.join(directory, 'objects'))
+            output = ['-o', 'objects']
+        log = os.path.join(directory, 'jlc.log')
+        with open(log, 'w') as f:
+            process = subprocess.Popen([jlc, '-ftime-report'] + flags + output + inputs, cwd=directory,
+                                       stdout=f, stderr=subprocess.STDOUT)
+            # wait4 reports the resources of this child only:
+            _, status, usage = os.wait4(process.pid, 0)
+        with open(log) as f:
+            report = f.read()
+        if status != 0:
+            raise RuntimeError('jlc failed on %s:\n%s' % (name, report))
+
+        phases = parse_report(report).get('phase', {})
+        result = {'size': size, 'lines': lines, 'rss_kb': usage.ru_maxrss}
+        for phase in PHASES:
+            wall = phases.get(phase, 0.0)
+            result[phase] = lines / wall if wall > 0 else 0.0
+        return result
+    finally:
+        shutil.rmtree(directory)
+
+
+def change(current, baseline):
+    if not baseline:
+        return ''
+    return '%+.0f%%' % (100.0 * (current - baseline) / baseline)
+
+
+def main():
+    parser = optparse.OptionParser()
+    parser.add_option('--jlc', default=os.path.join('build', 'jlc'), help='the compiler to measure')
+    parser.add_option('--scale', type='float', default=1.0, help='multiplies the size of all scenarios')
+    parser.add_option('--only', action='append', help='run only this scenario (may be repeated)')
+    parser.add_option('--parser', help='the front end of jlc (antlr or fast, default antlr)')
+    parser.add_option('--save-baseline', action='store_true', help='store the results as new baseline')
+    parser.add_option('--threshold', type='float', default=10.0,
+                      help='slowdown in percent that counts as regression (default 10)')
+    options, _ = parser.parse_args()
+
+    jlc = os.path.abspath(options.jlc)
+    flags = ['--parser=' + options.parser] if options.parser else []
+    baselines = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as f:
+            baselines = json.load(f)
+
+    results = {}
+    regressions = []
+    print('%-12s %8s %8s' % ('scenario', 'size', 'lines') + ''.join('%16s' % (p + ' l/s') for p in PHASES)
+          + '%12s' % 'rss (kB)')
+    for name, generator, size in generate.SCENARIOS:
+        if options.only and name not in options.only:
+            continue
+        size = max(1, int(size * options.scale))
+        result = measure(jlc, flags, name, generator, size)
+        results[name] = result
+
+        baseline = baselines.get(name)
+        if baseline and baseline['size'] != size:
+            baseline = None
+        print('%-12s %8d %8d' % (name, size, result['lines'])
+              + ''.join('%16.0f' % result[p] for p in PHASES) + '%12d' % result['rss_kb'])
+        if baseline:
+            print('%-12s %8s %8s' % ('', 'baseline', '')
+                  + ''.join('%16s' % change(result[p], baseline[p]) for p in PHASES)
+                  + '%12s' % change(result['rss_kb'], baseline['rss_kb']))
+            for p in PHASES:
+                if baseline[p] and result[p] < baseline[p] * (1 - options.threshold / 100.0):
+                    regressions.append('%s: %s' % (name, p))
+
+    if options.save_baseline:
+        baselines.update(results)
+        with open(BASELINE, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+        print('baseline saved to %s' % BASELINE)
+
+    if regressions:
+        print('regressions: ' + ', '.join(regressions))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -22,16 +22,16 @@ juli::CompilerError::CompilerError(const Indentable* node) :
 		node(node) {
 }
 
-const std::string& juli::CompilerError::getFile() const {
-	return node->filename;
+const std::string juli::CompilerError::getFile() const {
+	return node->getFilename();
 }
 
 const Marker juli::CompilerError::getStart() const {
-	return node->start;
+	return node->getStart();
 }
 
 const Marker juli::CompilerError::getEnd() const {
-	return node->end;
+	return node->getEnd();
 }
 
 std::ostream& operator<<(std::ostream& os, const juli::Error& ce) {
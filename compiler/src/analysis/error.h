@@ -37,7 +37,7 @@ public:
 
 	CompilerError(const Indentable* node);
 
-	const std::string& getFile() const;
+	const std::string getFile() const;
 
 	const Marker getStart() const;
 
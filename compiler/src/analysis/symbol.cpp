@@ -0,0 +1,39 @@
+#include "symbol.h"
+
+using namespace juli;
+
+pthread_rwlock_t juli::Symbol::lock = PTHREAD_RWLOCK_INITIALIZER;
+std::set<std::string> juli::Symbol::names;
+
+juli::Symbol::Symbol() :
+		name(0) {
+}
+
+juli::Symbol::Symbol(const std::string& name) :
+		name(0) {
+	// the empty name is the default symbol:
+	if (name.empty())
+		return;
+	// elements of a set never move:
+	pthread_rwlock_rdlock(&lock);
+	std::set<std::string>::iterator i = names.find(name);
+	if (i != names.end())
+		this->name = &*i;
+	pthread_rwlock_unlock(&lock);
+	if (this->name)
+		return;
+
+	pthread_rwlock_wrlock(&lock);
+	this->name = &*names.insert(name).first;
+	pthread_rwlock_unlock(&lock);
+}
+
+const std::string& juli::Symbol::str() const {
+	static const std::string empty;
+	return (name) ? *name : empty;
+}
+
+std::ostream& operator<<(std::ostream& os, const juli::Symbol& symbol) {
+	os << symbol.str();
+	return os;
+}
@@ -0,0 +1,52 @@
+/*
+ * symbol.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SYMBOL_H_
+#define SYMBOL_H_
+
+#include <ostream>
+#include <set>
+#include <string>
+#include <pthread.h>
+
+namespace juli {
+
+/*
+ * An interned name: equal names are the same symbol, so symbols are compared and ordered by pointer
+ * instead of by their characters. Interned names live as long as the process.
+ */
+class Symbol {
+private:
+	// most names are interned already, so lookups only take the read lock:
+	static pthread_rwlock_t lock;
+	static std::set<std::string> names;
+
+	const std::string* name;
+public:
+	Symbol();
+
+	explicit Symbol(const std::string& name);
+
+	const std::string& str() const;
+
+	bool operator==(const Symbol& s) const {
+		return name == s.name;
+	}
+
+	bool operator!=(const Symbol& s) const {
+		return name != s.name;
+	}
+
+	bool operator<(const Symbol& s) const {
+		return name < s.name;
+	}
+};
+
+}
+
+std::ostream& operator<<(std::ostream& os, const juli::Symbol& symbol);
+
+#endif /* SYMBOL_H_ */
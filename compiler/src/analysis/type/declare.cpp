@@ -7,7 +7,11 @@
 using namespace juli;
 
 juli::Declarator::Declarator(Importer& importer, bool importing) :
-		typeInfo(new TypeInfo(!importing)), importer(importer), importing(importing) {
+		typeInfo(new TypeInfo()), importer(importer), importing(importing) {
+}
+
+juli::Declarator::~Declarator() {
+	delete typeInfo;
 }
 
 void juli::Declarator::visit(const Node* n) {
@@ -25,7 +29,9 @@ TypeInfo* juli::Declarator::declare(const Node* n) {
 		typeInfo->defineFunction(*i, importing);
 	}
 
-	return typeInfo;
+	TypeInfo* result = typeInfo;
+	typeInfo = 0;
+	return result;
 }
 
 void juli::Declarator::visitDoubleLiteral(const NLiteral<double>* n) {
@@ -107,5 +113,5 @@ void juli::Declarator::visitClassDef(const NClassDefinition* n) {
 }
 
 void juli::Declarator::visitImport(const NImportStatement* n) {
-	typeInfo->merge(importer.getTypes(n->name->name));
+	typeInfo->addParent(importer.getTypes(n->name->name));
 }
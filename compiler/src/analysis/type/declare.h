@@ -39,6 +39,11 @@ public:
 
 	Declarator(Importer& importer, bool importing = false);
 
+	~Declarator();
+
+	/*
+	 * The caller owns the result, which is deleted with the declarator if declaring fails.
+	 */
 	TypeInfo* declare(const Node* n);
 
 	void visit(const Node* n);
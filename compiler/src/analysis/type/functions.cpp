@@ -7,7 +7,7 @@
 
 using namespace juli;
 
-std::map<std::string, Function*> juli::Function::functionPool;
+__thread FunctionPool* juli::FunctionPool::current = 0;
 
 Function* juli::Function::get(const NFunctionDefinition* functionDefinition, const TypeInfo& typeInfo, bool importing) {
 	const std::string& name = functionDefinition->signature->name;
@@ -19,16 +19,16 @@ Function* juli::Function::get(const NFunctionDefinition* functionDefinition, con
 	NBlock* body = (importing) ? 0 : functionDefinition->body;
 
 	if (name == "main") {
-		if (!(*resultType == PrimitiveType::INT32_TYPE)) {
+		if (resultType != &PrimitiveType::INT32_TYPE) {
 			CompilerError err(functionDefinition);
 			err.getStream() << "main must return " << PrimitiveType::INT32_TYPE;
 			throw err;
 		}
 
-		ArrayType p(new ArrayType(&PrimitiveType::INT8_TYPE));
-		if (formalArguments.size() != 1 || !(*formalArguments[0].type == p)) {
+		const ArrayType* p = TypeContext::getArray(TypeContext::getArray(&PrimitiveType::INT8_TYPE));
+		if (formalArguments.size() != 1 || formalArguments[0].type != p) {
 			CompilerError err(functionDefinition);
-			err.getStream() << "main may only have one parameter " << p;
+			err.getStream() << "main may only have one parameter " << *p;
 			throw err;
 		}
 	}
@@ -38,21 +38,83 @@ Function* juli::Function::get(const NFunctionDefinition* functionDefinition, con
 
 Function* juli::Function::get(const std::string& name, const Type* resultType, std::vector<FormalParameter>& argTypes,
 		bool varArgs, unsigned int modifiers, NBlock* body) {
-	std::string mangledName = mangleFunction(name, resultType, argTypes, varArgs, modifiers);
+	return FunctionPool::getCurrent().get(name, resultType, argTypes, varArgs, modifiers, body);
+}
 
-	Function* & f = functionPool[mangledName];
+juli::FunctionPool::Scope::Scope(FunctionPool& pool) :
+		previous(current) {
+	current = &pool;
+}
 
-	if (f == 0) {
-		f = new Function(name, resultType, argTypes, varArgs, modifiers, body);
+juli::FunctionPool::Scope::~Scope() {
+	current = previous;
+}
+
+juli::FunctionPool::FunctionPool(const FunctionPool* parent) :
+		parent(parent) {
+	pthread_mutex_init(&mutex, 0);
+}
+
+juli::FunctionPool::~FunctionPool() {
+	clear();
+	pthread_mutex_destroy(&mutex);
+}
+
+FunctionPool& juli::FunctionPool::getCurrent() {
+	if (!current) {
+		throw std::logic_error("no function pool in use");
+	}
+	return *current;
+}
+
+Function* juli::FunctionPool::find(const std::string& mangledName) const {
+	pthread_mutex_lock(&mutex);
+	std::map<std::string, Function*>::const_iterator i = functions.find(mangledName);
+	Function* f = (i != functions.end()) ? i->second : 0;
+	pthread_mutex_unlock(&mutex);
+	if (f)
+		return f;
+	return (parent) ? parent->find(mangledName) : 0;
+}
+
+void juli::FunctionPool::clear() {
+	pthread_mutex_lock(&mutex);
+	for (std::map<std::string, Function*>::iterator i = functions.begin(); i != functions.end(); ++i) {
+		delete i->second;
+	}
+	functions.clear();
+	pthread_mutex_unlock(&mutex);
+}
+
+Function* juli::FunctionPool::get(const std::string& name, const Type* resultType,
+		std::vector<FormalParameter>& argTypes, bool varArgs, unsigned int modifiers, NBlock* body) {
+	std::string mangledName = mangleFunction(name, resultType, argTypes, varArgs, modifiers);
+
+	// declarations of the parent pool are shared, a definition must not modify it:
+	Function* inherited = (parent && !body) ? parent->find(mangledName) : 0;
+
+	pthread_mutex_lock(&mutex);
+	std::map<std::string, Function*>::iterator i = functions.find(mangledName);
+	Function* f;
+	if (i != functions.end()) {
+		f = i->second;
+	} else if (inherited) {
+		pthread_mutex_unlock(&mutex);
+		return inherited;
 	} else {
-		if (body) {
-			if (f->body && f->body != body) {
-				CompilerError err(body);
-				err.getStream() << "Redefinition of function " << f;
-				throw err;
-			}
-			f->body = body;
+		f = new Function(name, resultType, argTypes, varArgs, modifiers, body);
+		f->pool = this;
+		functions[mangledName] = f;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if (body) {
+		if (f->body && f->body != body) {
+			CompilerError err(body);
+			err.getStream() << "Redefinition of function " << f;
+			throw err;
 		}
+		f->body = body;
 	}
 	return f;
 }
@@ -79,9 +141,9 @@ void juli::FormalParameter::print(std::ostream& os) const {
 
 juli::Function::Function(const std::string& name, const Type* resultType, std::vector<FormalParameter>& argTypes,
 		bool varArgs, unsigned int modifiers, NBlock* body) :
-		name(name), resultType(resultType), formalArguments(argTypes), varArgs(varArgs), modifiers(modifiers), body(
-				body) {
-
+		mangledName(mangleFunction(name, resultType, argTypes, varArgs, modifiers)), pool(0), name(name), symbol(name), resultType(
+				resultType), formalArguments(argTypes), varArgs(varArgs), modifiers(modifiers), body(body), llvmFunction(
+				0) {
 }
 
 unsigned int juli::Function::matches(std::vector<const Type*>& argTypes) const {
@@ -100,7 +162,7 @@ unsigned int juli::Function::matches(std::vector<const Type*>& argTypes) const {
 	int c = 1;
 	while (i != argTypes.end()) {
 		if (fi != formalArguments.end()) {
-			if (**i == *fi->type) {
+			if (*i == fi->type) {
 				s += 2;
 			} else if ((*i)->isAssignableTo(fi->type)) {
 				s += 1;
@@ -118,12 +180,26 @@ unsigned int juli::Function::matches(std::vector<const Type*>& argTypes) const {
 	return (s >= 0) ? s : 0;
 }
 
-const std::string juli::Function::mangle() const {
-	return mangleFunction(name, resultType, formalArguments, varArgs, modifiers);
+bool juli::Function::matchesExactly(const std::vector<const Type*>& argTypes) const {
+	if (argTypes.size() != formalArguments.size())
+		return false;
+	for (unsigned int i = 0; i < argTypes.size(); ++i) {
+		if (argTypes[i] != formalArguments[i].type)
+			return false;
+	}
+	return true;
+}
+
+const std::string& juli::Function::mangle() const {
+	return mangledName;
+}
+
+bool juli::Function::isOwnedBy(const FunctionPool& pool) const {
+	return this->pool == &pool;
 }
 
 bool juli::Function::operator==(const Function& f) {
-	return mangle() == f.mangle();
+	return mangledName == f.mangledName;
 }
 
 void juli::Function::print(std::ostream& os) const {
@@ -132,63 +208,93 @@ void juli::Function::print(std::ostream& os) const {
 
 //http://theory.uwinnipeg.ca/localfiles/infofiles/gcc/gxxint_15.html
 const std::string juli::mangleFunction(const std::string& name, const Type* resultType,
-		std::vector<FormalParameter> formalArguments, bool varArgs, unsigned int modifiers) {
+		const std::vector<FormalParameter>& formalArguments, bool varArgs, unsigned int modifiers) {
 	if ((modifiers & MODIFIER_C) || name == "main") {
 		return name;
 	} else {
-		std::stringstream s;
-		s << name << "__";
+		std::string s = name + "__";
 		for (std::vector<FormalParameter>::const_iterator i = formalArguments.begin(); i != formalArguments.end();
 				++i) {
-			s << i->type->mangle();
+			s += i->type->mangle();
 		}
-		return s.str();
+		return s;
 	}
 }
 
 void juli::Functions::addFunction(Function* function) {
-	std::set<Function*>& candidates = data[function->name];
-	candidates.insert(function);
-}
-
-std::vector<Function*> juli::Functions::resolve(const std::string& name, std::vector<const Type*>& argTypes) const {
-	std::vector<Function*> matches;
-
-	try {
-		const std::set<Function*> candidates = data.at(name);
-		unsigned int bestScore = 0;
-		for (std::set<Function*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
-			unsigned int s = (*i)->matches(argTypes);
-			if (s > bestScore) {
-				bestScore = s;
-				matches.clear();
-				matches.push_back(*i);
-			} else if (s == bestScore && bestScore > 0) {
-				matches.push_back(*i);
+	Overloads& overloads = data[function->symbol];
+	std::vector<Function*>& bucket =
+			(function->varArgs) ? overloads.varArgs : overloads.fixed[function->formalArguments.size()];
+
+	// a definition replaces an (imported) declaration of the same signature:
+	std::vector<Function*>* buckets[] = { &overloads.fixed[function->formalArguments.size()], &overloads.varArgs };
+	for (unsigned int b = 0; b < 2; ++b) {
+		for (std::vector<Function*>::iterator i = buckets[b]->begin(); i != buckets[b]->end(); ++i) {
+			if ((*i)->mangle() == function->mangle()) {
+				if (!function->body || (*i)->body)
+					return;
+				buckets[b]->erase(i);
+				break;
 			}
 		}
-		return matches;
-	} catch (std::out_of_range& e) {
-		return matches;
 	}
+	bucket.push_back(function);
+}
 
-	return matches;
+void juli::Functions::collect(const Symbol& name, unsigned int argCount, std::vector<Function*>& candidates) const {
+	std::map<Symbol, Overloads>::const_iterator o = data.find(name);
+	if (o == data.end())
+		return;
+
+	std::map<unsigned int, std::vector<Function*> >::const_iterator fixed = o->second.fixed.find(argCount);
+	if (fixed != o->second.fixed.end())
+		candidates.insert(candidates.end(), fixed->second.begin(), fixed->second.end());
+	for (std::vector<Function*>::const_iterator i = o->second.varArgs.begin(); i != o->second.varArgs.end(); ++i) {
+		if ((*i)->formalArguments.size() <= argCount)
+			candidates.push_back(*i);
+	}
 }
 
-void juli::Functions::merge(const Functions& other) {
-	typedef std::map<std::string, std::set<Function*> >::const_iterator ConstMapIterator;
-	typedef std::set<Function*>::const_iterator ConstFunctionIterator;
-	for (ConstMapIterator i = other.data.begin(); i != other.data.end(); ++i) {
-		const std::set<Function*> & newCandidates = i->second;
-		std::set<Function*> & candidates = data[i->first];
-		candidates.insert(newCandidates.begin(), newCandidates.end());
+void juli::Functions::select(const std::vector<Function*>& candidates, std::vector<const Type*>& argTypes,
+		std::vector<Function*>& matches) {
+	// signatures are unique, so an exact match is the only best one unless a var-arg function scores as well:
+	bool varArgs = false;
+	Function* exact = 0;
+	for (std::vector<Function*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+		varArgs = varArgs || (*i)->varArgs;
+		if (!exact && !(*i)->varArgs && (*i)->matchesExactly(argTypes))
+			exact = *i;
+	}
+	if (exact && !varArgs) {
+		matches.push_back(exact);
+		return;
+	}
+
+	unsigned int bestScore = 0;
+	for (std::vector<Function*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+		unsigned int s = (*i)->matches(argTypes);
+		if (s > bestScore) {
+			bestScore = s;
+			matches.clear();
+			matches.push_back(*i);
+		} else if (s == bestScore && bestScore > 0) {
+			matches.push_back(*i);
+		}
 	}
 }
 
 void juli::Functions::dump() const {
-	for (std::map<std::string, std::set<Function*> >::const_iterator i = data.begin(); i != data.end(); ++i) {
-		for (std::set<Function*>::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
-			std::cout << *j << std::endl;
+	typedef std::map<Symbol, Overloads>::const_iterator ConstMapIterator;
+	typedef std::map<unsigned int, std::vector<Function*> >::const_iterator ConstArityIterator;
+	typedef std::vector<Function*>::const_iterator ConstFunctionIterator;
+	for (ConstMapIterator i = data.begin(); i != data.end(); ++i) {
+		for (ConstArityIterator j = i->second.fixed.begin(); j != i->second.fixed.end(); ++j) {
+			for (ConstFunctionIterator k = j->second.begin(); k != j->second.end(); ++k) {
+				std::cout << *k << std::endl;
+			}
+		}
+		for (ConstFunctionIterator k = i->second.varArgs.begin(); k != i->second.varArgs.end(); ++k) {
+			std::cout << *k << std::endl;
 		}
 	}
 }
@@ -12,15 +12,23 @@
 
 #include <parser/ast/types.h>
 #include <parser/ast/ast.h>
+#include <analysis/symbol.h>
+
+#include <pthread.h>
 
 #include <map>
 #include <vector>
 #include <set>
 #include <string>
 
+namespace llvm {
+class Function;
+}
+
 namespace juli {
 
 class TypeInfo;
+class FunctionPool;
 
 class FormalParameter: public cpputils::debug::Printable {
 public:
@@ -40,7 +48,7 @@ public:
 
 class Function: public cpputils::debug::Printable {
 private:
-	static std::map<std::string, Function*> functionPool;
+	friend class FunctionPool;
 
 	//static Function* get(Function* fNew);
 
@@ -51,7 +59,10 @@ private:
 	Function(const std::string& name, const Type* resultType, std::vector<FormalParameter>& argTypes, bool varArgs,
 			unsigned int modifiers, NBlock* body = 0);
 
+	std::string mangledName;
 
+	// the pool owning this function:
+	const FunctionPool* pool;
 
 public:
 
@@ -61,6 +72,7 @@ public:
 			bool varArgs, unsigned int modifiers, NBlock* body = 0);
 
 	const std::string name;
+	const Symbol symbol;
 	const Type* resultType;
 	std::vector<FormalParameter> formalArguments;
 	bool varArgs;
@@ -68,9 +80,21 @@ public:
 	unsigned int modifiers;
 	NBlock* body;
 
+	/*
+	 * The function generated for this one, only used by the compilation owning the function (see IRGenerator).
+	 */
+	mutable llvm::Function* llvmFunction;
+
 	unsigned int matches(std::vector<const Type*>& argTypes) const;
 
-	const std::string mangle() const;
+	/*
+	 * True if all arguments have exactly the types of the parameters.
+	 */
+	bool matchesExactly(const std::vector<const Type*>& argTypes) const;
+
+	const std::string& mangle() const;
+
+	bool isOwnedBy(const FunctionPool& pool) const;
 
 	bool operator==(const Function& f);
 
@@ -78,19 +102,80 @@ public:
 
 };
 
-const std::string mangleFunction(const std::string& name, const Type* resultType, std::vector<FormalParameter> formalArguments, bool varArgs, unsigned int modifiers);
+/*
+ * Owns the functions of one compilation, so equal signatures map to one Function object.
+ *
+ * Function::get uses the pool the calling thread currently uses (see FunctionPool::Scope). A pool may have a
+ * read-only parent (e.g. the declarations of imported modules, which outlive a single compilation).
+ * Declarations found in the parent are shared, definitions always create a function in this pool.
+ */
+class FunctionPool {
+private:
+	static __thread FunctionPool* current;
+
+	const FunctionPool* parent;
+	std::map<std::string, Function*> functions;
+
+	// a parent pool may be read by several compilations while it is being extended:
+	mutable pthread_mutex_t mutex;
+
+	FunctionPool(const FunctionPool& copy);
+	void operator=(const FunctionPool& copy);
+
+	Function* find(const std::string& mangledName) const;
+public:
+
+	class Scope {
+	private:
+		FunctionPool* previous;
+	public:
+		Scope(FunctionPool& pool);
+		~Scope();
+	};
+
+	FunctionPool(const FunctionPool* parent = 0);
+	~FunctionPool();
+
+	static FunctionPool& getCurrent();
+
+	Function* get(const std::string& name, const Type* resultType, std::vector<FormalParameter>& argTypes,
+			bool varArgs, unsigned int modifiers, NBlock* body);
+
+	void clear();
+};
+
+const std::string mangleFunction(const std::string& name, const Type* resultType,
+		const std::vector<FormalParameter>& formalArguments, bool varArgs, unsigned int modifiers);
 
+/*
+ * The overloads of a scope, indexed by name and number of parameters, so resolving a call only scores the
+ * candidates that can take its arguments (see TypeInfo::findFunctions).
+ */
 class Functions {
 private:
-	std::map<std::string, std::set<Function*> > data;
-
+	class Overloads {
+	public:
+		// by number of parameters:
+		std::map<unsigned int, std::vector<Function*> > fixed;
+		std::vector<Function*> varArgs;
+	};
+
+	std::map<Symbol, Overloads> data;
 public:
 
 	void addFunction(Function* function);
 
-	std::vector<Function*> resolve(const std::string& name, std::vector<const Type*>& argTypes) const;
-
-	void merge(const Functions& other);
+	/*
+	 * Adds the overloads that may take the given number of arguments to candidates.
+	 */
+	void collect(const Symbol& name, unsigned int argCount, std::vector<Function*>& candidates) const;
+
+	/*
+	 * Adds the best matching candidates to matches (several if the call is ambiguous). The candidates must
+	 * have different signatures.
+	 */
+	static void select(const std::vector<Function*>& candidates, std::vector<const Type*>& argTypes,
+			std::vector<Function*>& matches);
 
 	void dump() const;
 
@@ -0,0 +1,191 @@
+#include "names.h"
+
+using namespace juli;
+
+juli::NameResolver::Binding::Binding(const Symbol& name, int slot) :
+		name(name), slot(slot) {
+}
+
+juli::NameResolver::NameResolver() :
+		slots(0), newScope(true) {
+}
+
+void juli::NameResolver::startScope() {
+	scopes.push_back(bindings.size());
+}
+
+void juli::NameResolver::endScope() {
+	bindings.resize(scopes.back(), Binding(Symbol(), 0));
+	scopes.pop_back();
+}
+
+void juli::NameResolver::declare(NVariableDeclaration* n) throw (CompilerError) {
+	const Symbol& name = n->name->symbol;
+	for (unsigned int i = scopes.back(); i < bindings.size(); ++i) {
+		if (bindings[i].name == name) {
+			CompilerError err(n);
+			err.getStream() << "Redefinition of symbol " << name;
+			throw err;
+		}
+	}
+
+	n->slot = slots++;
+	bindings.push_back(Binding(name, n->slot));
+}
+
+void juli::NameResolver::resolve(Node* n) throw (CompilerError) {
+	visit(n);
+}
+
+void juli::NameResolver::visit(Node* n) {
+	visitAST<NameResolver, void>(*this, n);
+}
+
+void juli::NameResolver::visitDoubleLiteral(NLiteral<double>* n) {
+}
+
+void juli::NameResolver::visitIntegerLiteral(NLiteral<uint64_t>* n) {
+}
+
+void juli::NameResolver::visitStringLiteral(NStringLiteral* n) {
+}
+
+void juli::NameResolver::visitCharLiteral(NCharLiteral* n) {
+}
+
+void juli::NameResolver::visitBooleanLiteral(NLiteral<bool>* n) {
+}
+
+void juli::NameResolver::visitNullLiteral(NLiteral<int>* n) {
+}
+
+void juli::NameResolver::visitVariableRef(NVariableRef* n) {
+	const Symbol& name = n->symbol;
+	for (std::vector<Binding>::reverse_iterator i = bindings.rbegin(); i != bindings.rend(); ++i) {
+		if (i->name == name) {
+			n->slot = i->slot;
+			return;
+		}
+	}
+
+	CompilerError err(n);
+	err.getStream() << "Unknown symbol " << n->name;
+	throw err;
+}
+
+void juli::NameResolver::visitQualifiedAccess(NQualifiedAccess* n) {
+	visit(n->ref);
+}
+
+void juli::NameResolver::visitCast(NCast* n) {
+	visit(n->expression);
+}
+
+void juli::NameResolver::visitUnaryOperator(NUnaryOperator* n) {
+	visit(n->expression);
+}
+
+void juli::NameResolver::visitBinaryOperator(NBinaryOperator* n) {
+	visit(n->lhs);
+	visit(n->rhs);
+}
+
+void juli::NameResolver::visitAllocateArray(NAllocateArray* n) {
+	for (ExpressionList::iterator i = n->sizes.begin(); i != n->sizes.end(); ++i) {
+		visit(*i);
+	}
+}
+
+void juli::NameResolver::visitAllocateObject(NAllocateObject* n) {
+}
+
+void juli::NameResolver::visitFunctionCall(NFunctionCall* n) {
+	for (ExpressionList::iterator i = n->arguments.begin(); i != n->arguments.end(); ++i) {
+		visit(*i);
+	}
+}
+
+void juli::NameResolver::visitArrayAccess(NArrayAccess* n) {
+	visit(n->ref);
+	for (ExpressionList::iterator i = n->indices.begin(); i != n->indices.end(); ++i) {
+		visit(*i);
+	}
+}
+
+void juli::NameResolver::visitAssignment(NAssignment* n) {
+	visit(n->rhs);
+	visit(n->lhs);
+}
+
+void juli::NameResolver::visitBlock(NBlock* n) {
+	if (newScope) {
+		startScope();
+	} else {
+		newScope = true;
+	}
+
+	for (StatementList::iterator i = n->statements.begin(); i != n->statements.end(); ++i) {
+		visit(*i);
+	}
+
+	endScope();
+}
+
+void juli::NameResolver::visitExpressionStatement(NExpressionStatement* n) {
+	visit(n->expression);
+}
+
+void juli::NameResolver::visitVariableDecl(NVariableDeclaration* n) {
+	// the initializer can't see the variable itself:
+	if (n->assignmentExpr)
+		visit(n->assignmentExpr);
+	declare(n);
+}
+
+void juli::NameResolver::visitFunctionDef(NFunctionDefinition* n) {
+	std::vector<Binding> outerBindings;
+	std::vector<unsigned int> outerScopes;
+	outerBindings.swap(bindings);
+	outerScopes.swap(scopes);
+	int outerSlots = slots;
+	slots = 0;
+
+	startScope();
+	for (VariableList::iterator i = n->signature->arguments.begin(); i != n->signature->arguments.end(); ++i) {
+		declare(*i);
+	}
+	if (n->body) {
+		newScope = false;
+		visit(n->body);
+	} else {
+		endScope();
+	}
+
+	bindings.swap(outerBindings);
+	scopes.swap(outerScopes);
+	slots = outerSlots;
+}
+
+void juli::NameResolver::visitReturn(NReturnStatement* n) {
+	if (n->expression)
+		visit(n->expression);
+}
+
+void juli::NameResolver::visitIf(NIfStatement* n) {
+	for (std::vector<NIfClause*>::iterator i = n->clauses.begin(); i != n->clauses.end(); ++i) {
+		if ((*i)->condition)
+			visit((*i)->condition);
+		visit((*i)->body);
+	}
+}
+
+void juli::NameResolver::visitWhile(NWhileStatement* n) {
+	visit(n->condition);
+	visit(n->body);
+}
+
+void juli::NameResolver::visitClassDef(NClassDefinition* n) {
+}
+
+void juli::NameResolver::visitImport(NImportStatement* n) {
+}
@@ -0,0 +1,113 @@
+/*
+ * names.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef NAMES_H_
+#define NAMES_H_
+
+#include <parser/ast/visitor.h>
+#include <analysis/symbol.h>
+#include <analysis/error.h>
+
+#include <vector>
+
+namespace juli {
+
+/*
+ * Binds every variable reference to its declaration. The variables of a function are numbered in order
+ * of declaration, starting with the parameters, and each reference gets the slot of the declaration
+ * visible to it. Type checker and code generator keep the variables of the current function in arrays
+ * indexed by slot, so shadowed variables of enclosing blocks keep their own slots.
+ *
+ * A function only sees its own parameters and variables. The statements outside of functions are numbered
+ * like another function.
+ */
+class NameResolver {
+private:
+	class Binding {
+	public:
+		Symbol name;
+		int slot;
+
+		Binding(const Symbol& name, int slot);
+	};
+
+	// the visible variables of the current function, innermost last:
+	std::vector<Binding> bindings;
+	// where the scopes of the current function start in bindings:
+	std::vector<unsigned int> scopes;
+	int slots;
+
+	// the body of a function shares the scope of its parameters:
+	bool newScope;
+
+	void startScope();
+
+	void endScope();
+
+	void declare(NVariableDeclaration* n) throw (CompilerError);
+public:
+
+	NameResolver();
+
+	void resolve(Node* n) throw (CompilerError);
+
+	void visit(Node* n);
+
+	void visitDoubleLiteral(NLiteral<double>* n);
+
+	void visitIntegerLiteral(NLiteral<uint64_t>* n);
+
+	void visitStringLiteral(NStringLiteral* n);
+
+	void visitCharLiteral(NCharLiteral* n);
+
+	void visitBooleanLiteral(NLiteral<bool>* n);
+
+	void visitNullLiteral(NLiteral<int>* n);
+
+	void visitVariableRef(NVariableRef* n);
+
+	void visitQualifiedAccess(NQualifiedAccess* n);
+
+	void visitCast(NCast* n);
+
+	void visitUnaryOperator(NUnaryOperator* n);
+
+	void visitBinaryOperator(NBinaryOperator* n);
+
+	void visitAllocateArray(NAllocateArray* n);
+
+	void visitAllocateObject(NAllocateObject* n);
+
+	void visitFunctionCall(NFunctionCall* n);
+
+	void visitArrayAccess(NArrayAccess* n);
+
+	void visitAssignment(NAssignment* n);
+
+	void visitBlock(NBlock* n);
+
+	void visitExpressionStatement(NExpressionStatement* n);
+
+	void visitVariableDecl(NVariableDeclaration* n);
+
+	void visitFunctionDef(NFunctionDefinition* n);
+
+	void visitReturn(NReturnStatement* n);
+
+	void visitIf(NIfStatement* n);
+
+	void visitWhile(NWhileStatement* n);
+
+	void visitClassDef(NClassDefinition* n);
+
+	void visitImport(NImportStatement* n);
+
+};
+
+}
+
+#endif /* NAMES_H_ */
@@ -0,0 +1,89 @@
+#include "operators.h"
+
+#include <analysis/type/typeinfo.h>
+
+#include <sstream>
+
+using namespace juli;
+
+pthread_once_t juli::OperatorTable::once = PTHREAD_ONCE_INIT;
+Symbol juli::OperatorTable::names[UNKNOWN + 1];
+OperatorTable::Entry juli::OperatorTable::unary[UNKNOWN][PRIMITIVES];
+OperatorTable::Entry juli::OperatorTable::binary[UNKNOWN][PRIMITIVES][PRIMITIVES];
+
+static void setEntry(OperatorTable::Entry& entry, const Functions& functions, const Symbol& name,
+		std::vector<const Type*>& argTypes) {
+	std::vector<Function*> candidates;
+	std::vector<Function*> matches;
+	functions.collect(name, argTypes.size(), candidates);
+	Functions::select(candidates, argTypes, matches);
+	// ambiguous calls are left to the function resolution, which reports them:
+	if (matches.size() != 1)
+		return;
+	const Function* f = matches.front();
+	entry.resultType = f->resultType;
+	for (unsigned int i = 0; i < f->formalArguments.size(); ++i) {
+		entry.operandTypes[i] = f->formalArguments[i].type;
+	}
+}
+
+void juli::OperatorTable::init() {
+	// the implicit operators are resolved once with the rules for functions:
+	const Functions& functions = TypeInfo::getBuiltins().getFunctions();
+
+	for (unsigned int op = 0; op <= UNKNOWN; ++op) {
+		std::stringstream s;
+		s << (Operator) op;
+		names[op] = Symbol(s.str());
+	}
+
+	for (unsigned int op = 0; op < UNKNOWN; ++op) {
+		for (unsigned int i = 0; i < PRIMITIVES; ++i) {
+			std::vector<const Type*> argTypes(1, getType(i));
+			setEntry(unary[op][i], functions, names[op], argTypes);
+
+			argTypes.push_back(0);
+			for (unsigned int j = 0; j < PRIMITIVES; ++j) {
+				argTypes[1] = getType(j);
+				setEntry(binary[op][i][j], functions, names[op], argTypes);
+			}
+		}
+	}
+}
+
+int juli::OperatorTable::getIndex(const Type* type) {
+	if (type->getCategory() != PRIMITIVE)
+		return -1;
+	return static_cast<const PrimitiveType*>(type)->getPrimitive() - NIL;
+}
+
+const Type* juli::OperatorTable::getType(unsigned int index) {
+	static const PrimitiveType* types[PRIMITIVES] = { &PrimitiveType::NULL_TYPE, &PrimitiveType::VOID_TYPE,
+			&PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::INT8_TYPE, &PrimitiveType::INT32_TYPE,
+			&PrimitiveType::FLOAT64_TYPE };
+	return types[index];
+}
+
+const OperatorTable::Entry* juli::OperatorTable::getUnary(Operator op, const Type* operand) {
+	pthread_once(&once, init);
+	int i = getIndex(operand);
+	if (op >= UNKNOWN || i < 0)
+		return 0;
+	const Entry* entry = &unary[op][i];
+	return (entry->resultType) ? entry : 0;
+}
+
+const OperatorTable::Entry* juli::OperatorTable::getBinary(Operator op, const Type* lhs, const Type* rhs) {
+	pthread_once(&once, init);
+	int i = getIndex(lhs);
+	int j = getIndex(rhs);
+	if (op >= UNKNOWN || i < 0 || j < 0)
+		return 0;
+	const Entry* entry = &binary[op][i][j];
+	return (entry->resultType) ? entry : 0;
+}
+
+const Symbol& juli::OperatorTable::getName(Operator op) {
+	pthread_once(&once, init);
+	return names[op];
+}
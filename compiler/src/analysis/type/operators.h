@@ -0,0 +1,65 @@
+/*
+ * operators.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef OPERATORS_H_
+#define OPERATORS_H_
+
+#include <parser/ast/node.h>
+#include <parser/ast/types.h>
+#include <analysis/symbol.h>
+
+#include <pthread.h>
+
+namespace juli {
+
+/*
+ * The implicit operators on primitive types (see TypeInfo), resolved once for every combination of
+ * operand types, so type checking an operator on primitives is an array lookup. Operators on other
+ * types are resolved like functions, by the name of the operator.
+ */
+class OperatorTable {
+public:
+	class Entry {
+	public:
+		// 0 if the operator is not defined for the operand types:
+		const Type* resultType;
+		// the types the operands are coerced to:
+		const Type* operandTypes[2];
+	};
+private:
+	// NIL to FLOAT64:
+	static const unsigned int PRIMITIVES = 6;
+
+	static pthread_once_t once;
+	static Symbol names[UNKNOWN + 1];
+	static Entry unary[UNKNOWN][PRIMITIVES];
+	static Entry binary[UNKNOWN][PRIMITIVES][PRIMITIVES];
+
+	static void init();
+
+	static int getIndex(const Type* type);
+
+	static const Type* getType(unsigned int index);
+public:
+	/*
+	 * The implicit operator for the operand type, or 0 if there is none.
+	 */
+	static const Entry* getUnary(Operator op, const Type* operand);
+
+	/*
+	 * The implicit operator for the operand types, or 0 if there is none.
+	 */
+	static const Entry* getBinary(Operator op, const Type* lhs, const Type* rhs);
+
+	/*
+	 * The name the operator is declared with.
+	 */
+	static const Symbol& getName(Operator op);
+};
+
+}
+
+#endif /* OPERATORS_H_ */
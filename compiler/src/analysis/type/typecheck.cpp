@@ -5,58 +5,13 @@
 #include <debug/print.h>
 #include <cassert>
 
-using namespace juli;
-
-juli::SymbolTable::SymbolTable(const TypeInfo& typeInfo) :
-		typeInfo(typeInfo) {
-}
-
-void juli::SymbolTable::startScope(
-		const std::vector<NVariableDeclaration*> functionParams) {
-	startScope();
-	for (std::vector<NVariableDeclaration*>::const_iterator i =
-			functionParams.begin(); i != functionParams.end(); ++i) {
-		addSymbol(*i);
-	}
-}
-
-void juli::SymbolTable::startScope() {
-	scopes.push_back(std::map<std::string, const Type*>());
-}
-
-void juli::SymbolTable::endScope() {
-	scopes.pop_back();
-}
+#include <profile/profiler.h>
+#include <analysis/type/operators.h>
 
-const Type* juli::SymbolTable::getSymbol(const std::string& name) const {
-	for (ScopeStack::const_iterator i = --scopes.end(); i >= scopes.begin();
-			--i) {
-		Scope::const_iterator si = i->find(name);
-		if (si != i->end())
-			return si->second;
-	}
-	return 0;
-}
-
-void juli::SymbolTable::addSymbol(const std::string& name, const Type* type,
-		const Node* n) {
-	Scope& currentScope = scopes.back();
-	if (currentScope.find(name) != currentScope.end()) {
-		CompilerError err(n);
-		err.getStream() << "Redefinition of symbol " << name;
-		throw err;
-	}
-
-	currentScope[name] = type;
-}
-
-void juli::SymbolTable::addSymbol(NVariableDeclaration* node) {
-	addSymbol(node->name->name, node->type->resolve(typeInfo), node);
-}
+using namespace juli;
 
 juli::TypeChecker::TypeChecker(const TypeInfo& typeInfo) :
-		symbolTable(typeInfo), typeInfo(typeInfo) {
-	_newScope = true;
+		typeInfo(typeInfo) {
 	_addressing = false;
 	_currentFunction = 0;
 }
@@ -64,7 +19,7 @@ juli::TypeChecker::TypeChecker(const TypeInfo& typeInfo) :
 NExpression* juli::TypeChecker::checkAssignment(const Type* left,
 		NExpression* right, const Indentable* n,
 		const std::string& message) const {
-	if (!(*left == *right->expressionType)) {
+	if (left != right->expressionType) {
 
 		if (!right->expressionType->isAssignableTo(left)) {
 			CompilerError err(n);
@@ -81,7 +36,7 @@ NExpression* juli::TypeChecker::checkAssignment(const Type* left,
 }
 
 NExpression* juli::TypeChecker::coerce(NExpression* e, const Type* type) const {
-	if (!(*e->expressionType == *type)) {
+	if (e->expressionType != type) {
 		NCast* c = new NCast(e, 0);
 		c->expressionType = type;
 		return c;
@@ -103,6 +58,12 @@ void juli::TypeChecker::coerce(ExpressionList& expressions,
 	}
 }
 
+void juli::TypeChecker::declareVariable(NVariableDeclaration* n) {
+	if (n->slot >= (int) variables.size())
+		variables.resize(n->slot + 1);
+	variables[n->slot] = n->type->resolve(typeInfo);
+}
+
 const Type* juli::TypeChecker::visit(Node* n) {
 	return visitAST<TypeChecker, const Type*>(*this, n);
 }
@@ -132,14 +93,7 @@ const Type* juli::TypeChecker::visitNullLiteral(const NLiteral<int>* n) {
 }
 
 const Type* juli::TypeChecker::visitVariableRef(NVariableRef* n) {
-	n->expressionType = symbolTable.getSymbol(n->name);
-
-	if (!n->expressionType) {
-		CompilerError err(n);
-		err.getStream() << "Unknown symbol " << n->name;
-		throw err;
-	}
-
+	n->expressionType = variables[n->slot];
 	return n->expressionType;
 }
 
@@ -180,13 +134,17 @@ const Type* juli::TypeChecker::visitUnaryOperator(NUnaryOperator* n) {
 
 	const Type* etype = visit(n->expression);
 
-	std::stringstream sstr;
-	sstr << n->op;
+	const OperatorTable::Entry* entry = OperatorTable::getUnary(n->op, etype);
+	if (entry) {
+		n->expression = coerce(n->expression, entry->operandTypes[0]);
+		n->expressionType = entry->resultType;
+		return n->expressionType;
+	}
 
 	std::vector<const Type*> argTypes;
 	argTypes.push_back(etype);
 
-	Function* f = typeInfo.resolveFunction(sstr.str(), argTypes, n);
+	Function* f = typeInfo.resolveFunction(OperatorTable::getName(n->op), argTypes, n);
 	n->expression = coerce(n->expression, f->formalArguments[0].type);
 
 	n->expressionType = f->resultType;
@@ -199,14 +157,19 @@ const Type* juli::TypeChecker::visitBinaryOperator(NBinaryOperator* n) {
 	const Type* lhs = visit(n->lhs);
 	const Type* rhs = visit(n->rhs);
 
-	std::stringstream sstr;
-	sstr << n->op;
+	const OperatorTable::Entry* entry = OperatorTable::getBinary(n->op, lhs, rhs);
+	if (entry) {
+		n->lhs = coerce(n->lhs, entry->operandTypes[0]);
+		n->rhs = coerce(n->rhs, entry->operandTypes[1]);
+		n->expressionType = entry->resultType;
+		return n->expressionType;
+	}
 
 	std::vector<const Type*> argTypes;
 	argTypes.push_back(lhs);
 	argTypes.push_back(rhs);
 
-	Function* f = typeInfo.resolveFunction(sstr.str(), argTypes, n);
+	Function* f = typeInfo.resolveFunction(OperatorTable::getName(n->op), argTypes, n);
 	n->lhs = coerce(n->lhs, f->formalArguments[0].type);
 	n->rhs = coerce(n->rhs, f->formalArguments[1].type);
 
@@ -236,7 +199,9 @@ const Type* juli::TypeChecker::visitAllocateObject(NAllocateObject* n) {
 
 const Type* juli::TypeChecker::visitFunctionCall(NFunctionCall* n) {
 
-	if (n->name->name == "main") {
+	// constructed on first use, after the interned names:
+	static const Symbol MAIN("main");
+	if (n->name->symbol == MAIN) {
 		CompilerError err(n);
 		err.getStream() << "Calling main is not allowed";
 		throw err;
@@ -250,7 +215,7 @@ const Type* juli::TypeChecker::visitFunctionCall(NFunctionCall* n) {
 
 	n->expressionType = 0;
 
-	n->function = typeInfo.resolveFunction(n->name->name, argTypes, n);
+	n->function = typeInfo.resolveFunction(n->name->symbol, argTypes, n);
 	n->expressionType = n->function->resultType;
 
 	coerce(n->arguments, n->function->formalArguments);
@@ -285,6 +250,14 @@ const Type* juli::TypeChecker::visitArrayAccess(NArrayAccess* n) {
 	return n->expressionType;
 }
 
+// the fields of an array header (a.length, m.length[i]) are constant (see TypeAliasInfo):
+static bool isArrayHeaderField(const NExpression* e) {
+	if (const NArrayAccess* aa = dynamic_cast<const NArrayAccess*>(e))
+		return isArrayHeaderField(aa->ref);
+	const NQualifiedAccess* qa = dynamic_cast<const NQualifiedAccess*>(e);
+	return qa && qa->ref->expressionType->getCategory() == ARRAY;
+}
+
 const Type* juli::TypeChecker::visitAssignment(NAssignment* n) {
 	visit(n->rhs);
 	visit(n->lhs);
@@ -297,6 +270,12 @@ const Type* juli::TypeChecker::visitAssignment(NAssignment* n) {
 		throw err;
 	}
 
+	if (isArrayHeaderField(n->lhs)) {
+		CompilerError err(n);
+		err.getStream() << "Cannot assign to the length of an array";
+		throw err;
+	}
+
 	addressable->address = true;
 
 	const Type* varType = n->lhs->expressionType;
@@ -306,12 +285,6 @@ const Type* juli::TypeChecker::visitAssignment(NAssignment* n) {
 }
 
 const Type* juli::TypeChecker::visitBlock(NBlock* n) {
-	if (_newScope) {
-		symbolTable.startScope();
-	} else {
-		_newScope = true;
-	}
-
 	for (StatementList::iterator i = n->statements.begin();
 			i != n->statements.end(); ++i) {
 		visit(*i);
@@ -323,7 +296,6 @@ const Type* juli::TypeChecker::visitBlock(NBlock* n) {
 		n->terminates = true;
 	}
 
-	symbolTable.endScope();
 	return 0;
 }
 
@@ -341,19 +313,23 @@ const Type* juli::TypeChecker::visitVariableDecl(NVariableDeclaration* n) {
 		n->assignmentExpr = checkAssignment(varType, n->assignmentExpr, n);
 	}
 
-	symbolTable.addSymbol(n);
+	declareVariable(n);
 	return 0;
 }
 
 const Type* juli::TypeChecker::visitFunctionDef(NFunctionDefinition* n) {
+	ProfileScope profile("typecheck", n->signature->name, true);
 	_currentFunction = n;
-	symbolTable.startScope(n->signature->arguments);
-	_newScope = false;
+	std::vector<const Type*> outerVariables;
+	outerVariables.swap(variables);
+	for (VariableList::iterator i = n->signature->arguments.begin(); i != n->signature->arguments.end(); ++i) {
+		declareVariable(*i);
+	}
 	if (n->body) {
 		visit(n->body);
 		if (!n->body->terminates) {
 			const Type* t = n->signature->type->resolve(typeInfo);
-			if (*t == PrimitiveType::VOID_TYPE) {
+			if (t == &PrimitiveType::VOID_TYPE) {
 				n->body->addStatement(new NReturnStatement(0)); // auto return void
 			} else {
 				// require value return:
@@ -363,11 +339,9 @@ const Type* juli::TypeChecker::visitFunctionDef(NFunctionDefinition* n) {
 				throw err;
 			}
 		}
-	} else {
-		_newScope = true;
-		symbolTable.endScope();
 	}
 
+	variables.swap(outerVariables);
 	_currentFunction = 0;
 	return 0;
 }
@@ -380,7 +354,7 @@ const Type* juli::TypeChecker::visitReturn(NReturnStatement* n) {
 
 		n->expression = checkAssignment(functionReturnType, n->expression, n);
 	} else {
-		if (!(*functionReturnType == PrimitiveType::VOID_TYPE)) {
+		if (functionReturnType != &PrimitiveType::VOID_TYPE) {
 			CompilerError err(n);
 			err.getStream() << "Function need to return a value of type "
 					<< functionReturnType;
@@ -18,41 +18,16 @@
 
 namespace juli {
 
-class SymbolTable {
-private:
-
-	typedef std::map<std::string, const Type*> Scope;
-	typedef std::vector<Scope> ScopeStack;
-
-	ScopeStack scopes;
-	const TypeInfo& typeInfo;
-public:
-
-	SymbolTable(const TypeInfo& typeInfo);
-
-	~SymbolTable() {
-	}
-
-	void startScope(const std::vector<NVariableDeclaration*> functionParams);
-
-	void startScope();
-
-	void endScope();
-
-	const Type* getSymbol(const std::string& name) const;
-
-	void addSymbol(const std::string& name, const Type* type, const Node* n);
-
-	void addSymbol(NVariableDeclaration* node);
-
-};
-
+/*
+ * Derives the types of all expressions. Variable references have to be resolved first (see NameResolver).
+ */
 class TypeChecker {
 private:
-	SymbolTable symbolTable;
 	const TypeInfo& typeInfo;
 
-	bool _newScope;
+	// the types of the variables of the current function, by slot:
+	std::vector<const Type*> variables;
+
 	bool _addressing;
 	NFunctionDefinition* _currentFunction;
 public:
@@ -65,6 +40,8 @@ public:
 
 	void coerce(ExpressionList& expressions, std::vector<FormalParameter> params) const;
 
+	void declareVariable(NVariableDeclaration* n);
+
 	const Type* visit(Node* n);
 
 	const Type* visitDoubleLiteral(NLiteral<double>* n);
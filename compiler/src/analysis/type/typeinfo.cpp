@@ -2,72 +2,96 @@
 
 #include <parser/ast/ast.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 using namespace juli;
 
-std::map<std::string, Type*> juli::TypeInfo::implicitTypes;
+pthread_once_t juli::TypeInfo::builtinsOnce = PTHREAD_ONCE_INIT;
+TypeInfo* juli::TypeInfo::builtins = 0;
+FunctionPool* juli::TypeInfo::builtinFunctions = 0;
 
-juli::TypeInfo::TypeInfo(bool implicit) {
-	if (implicitTypes.empty()) {
-		implicitTypes["double"] = new PrimitiveType(FLOAT64);
-		implicitTypes["void"] = new PrimitiveType(VOID);
-		implicitTypes["int"] = new PrimitiveType(INT32);
-		implicitTypes["char"] = new PrimitiveType(INT8);
-		implicitTypes["boolean"] = new PrimitiveType(BOOLEAN);
-	}
+void juli::TypeInfo::initBuiltins() {
+	// the implicit operators live as long as the process:
+	builtinFunctions = new FunctionPool();
+	FunctionPool::Scope scope(*builtinFunctions);
+	builtins = new TypeInfo(true);
+}
 
-	// initialize primitive types:
-	mergeMaps(typeTable, implicitTypes);
-	if (implicit) {
-		// implicit declarations:
-		std::vector<std::string> comparison;
-		comparison.push_back(">");
-		comparison.push_back("<");
-		comparison.push_back(">=");
-		comparison.push_back("<=");
-		comparison.push_back("==");
-		comparison.push_back("!=");
-		declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::INT8_TYPE, 2);
-		declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::INT32_TYPE, 2);
-		declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
-
-		std::vector<std::string> equality;
-		equality.push_back("==");
-		equality.push_back("!=");
-		declareImplicitOperator(equality, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 2);
-		declareImplicitOperator(equality, &PrimitiveType::BOOLEAN_TYPE, &ReferenceType::REFERENCE_TYPE, 2);
-
-		std::vector<std::string> arithmetic;
-		arithmetic.push_back("+");
-		arithmetic.push_back("-");
-		arithmetic.push_back("/");
-		arithmetic.push_back("*");
-		declareImplicitOperator(arithmetic, &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 2);
-		declareImplicitOperator(arithmetic, &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 2);
-		declareImplicitOperator(arithmetic, &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
-
-		declareImplicitOperator("%", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 2);
-		declareImplicitOperator("%", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 2);
-		declareImplicitOperator("%", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
-
-		std::vector<std::string> logical;
-		logical.push_back("and");
-		logical.push_back("or");
-		declareImplicitOperator(logical, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 2);
-
-		declareImplicitOperator("not", &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 1);
-
-		declareImplicitOperator("-", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 1);
-		declareImplicitOperator("-", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 1);
-		declareImplicitOperator("-", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 1);
-
-		declareImplicitOperator("~", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 1);
-		declareImplicitOperator("~", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 1);
-		declareImplicitOperator("~", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 1);
+const TypeInfo& juli::TypeInfo::getBuiltins() {
+	pthread_once(&builtinsOnce, initBuiltins);
+	return *builtins;
+}
+
+juli::TypeInfo::TypeInfo() {
+	scopes.push_back(this);
+	addParent(getBuiltins());
+}
+
+juli::TypeInfo::~TypeInfo() {
+	// the primitive types of the builtin scope are not allocated:
+	for (std::map<std::string, Type*>::iterator i = typeTable.begin(); i != typeTable.end(); ++i) {
+		if (i->second->getCategory() == CLASS)
+			delete i->second;
 	}
 }
 
+juli::TypeInfo::TypeInfo(bool builtin) {
+	scopes.push_back(this);
+
+	typeTable["double"] = const_cast<PrimitiveType*>(&PrimitiveType::FLOAT64_TYPE);
+	typeTable["void"] = const_cast<PrimitiveType*>(&PrimitiveType::VOID_TYPE);
+	typeTable["int"] = const_cast<PrimitiveType*>(&PrimitiveType::INT32_TYPE);
+	typeTable["char"] = const_cast<PrimitiveType*>(&PrimitiveType::INT8_TYPE);
+	typeTable["boolean"] = const_cast<PrimitiveType*>(&PrimitiveType::BOOLEAN_TYPE);
+
+	// implicit declarations:
+	std::vector<std::string> comparison;
+	comparison.push_back(">");
+	comparison.push_back("<");
+	comparison.push_back(">=");
+	comparison.push_back("<=");
+	comparison.push_back("==");
+	comparison.push_back("!=");
+	declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::INT8_TYPE, 2);
+	declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::INT32_TYPE, 2);
+	declareImplicitOperator(comparison, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
+
+	std::vector<std::string> equality;
+	equality.push_back("==");
+	equality.push_back("!=");
+	declareImplicitOperator(equality, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 2);
+	declareImplicitOperator(equality, &PrimitiveType::BOOLEAN_TYPE, &ReferenceType::REFERENCE_TYPE, 2);
+
+	std::vector<std::string> arithmetic;
+	arithmetic.push_back("+");
+	arithmetic.push_back("-");
+	arithmetic.push_back("/");
+	arithmetic.push_back("*");
+	declareImplicitOperator(arithmetic, &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 2);
+	declareImplicitOperator(arithmetic, &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 2);
+	declareImplicitOperator(arithmetic, &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
+
+	declareImplicitOperator("%", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 2);
+	declareImplicitOperator("%", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 2);
+	declareImplicitOperator("%", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 2);
+
+	std::vector<std::string> logical;
+	logical.push_back("and");
+	logical.push_back("or");
+	declareImplicitOperator(logical, &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 2);
+
+	declareImplicitOperator("not", &PrimitiveType::BOOLEAN_TYPE, &PrimitiveType::BOOLEAN_TYPE, 1);
+
+	declareImplicitOperator("-", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 1);
+	declareImplicitOperator("-", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 1);
+	declareImplicitOperator("-", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 1);
+
+	declareImplicitOperator("~", &PrimitiveType::INT8_TYPE, &PrimitiveType::INT8_TYPE, 1);
+	declareImplicitOperator("~", &PrimitiveType::INT32_TYPE, &PrimitiveType::INT32_TYPE, 1);
+	declareImplicitOperator("~", &PrimitiveType::FLOAT64_TYPE, &PrimitiveType::FLOAT64_TYPE, 1);
+}
+
 void juli::TypeInfo::declareImplicitOperator(const std::vector<std::string> names, const Type* returnType,
 		const Type* type, unsigned int arity) {
 	for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i) {
@@ -110,38 +134,81 @@ void juli::TypeInfo::defineClass(const NClassDefinition* def) {
 }
 
 void juli::TypeInfo::declareClass(const NClassDefinition* def) {
-	std::vector<Field> fields;
-	ClassType* type = new ClassType(def->name->name, fields);
-
-	std::map<std::string, Type*>::iterator i = typeTable.find(def->name->name);
-	if (i != typeTable.end()) {
+	if (findType(def->name->name)) {
 		CompilerError err(def);
 		err.getStream() << "Redefinition of type " << def->name->name;
 		throw err;
 	}
 
+	std::vector<Field> fields;
+	ClassType* type = new ClassType(def->name->name, fields);
+
 	typeTable[def->name->name] = type;
 	unresolvedTypes[def->name->name] = def;
 }
 
+void juli::TypeInfo::declareClass(ClassType* type) {
+	if (findType(type->getName())) {
+		ImportError err;
+		err.getStream() << "Redefinition of type " << type->getName();
+		delete type;
+		throw err;
+	}
+	typeTable[type->getName()] = type;
+}
+
 void juli::TypeInfo::resolveClasses() {
 	for (std::map<std::string, const NClassDefinition*>::iterator i = unresolvedTypes.begin();
 			i != unresolvedTypes.end(); ++i) {
 		defineClass(i->second);
 	}
+	// resolved once, the fields must not be added twice:
+	unresolvedTypes.clear();
 }
 
 void juli::TypeInfo::declareFunction(Function* f) {
 	functions.addFunction(f);
+	resolvedCalls.clear();
 }
 
-Function* juli::TypeInfo::resolveFunction(const std::string& name, std::vector<const Type*>& argTypes,
-		const Indentable* astNode) const throw (CompilerError) {
-	std::vector<Function*> matches;
-	try {
-		matches = functions.resolve(name, argTypes);
-	} catch (std::out_of_range& e) {
+const std::vector<Function*>& juli::TypeInfo::findFunctions(const Symbol& name,
+		std::vector<const Type*>& argTypes) const {
+	Call call(name, argTypes);
+	std::map<Call, std::vector<Function*> >::iterator r = resolvedCalls.find(call);
+	if (r != resolvedCalls.end())
+		return r->second;
+
+	std::vector<Function*> candidates;
+	for (std::vector<const TypeInfo*>::const_iterator s = scopes.begin(); s != scopes.end(); ++s) {
+		unsigned int inherited = candidates.size();
+		(*s)->functions.collect(name, argTypes.size(), candidates);
+
+		// a signature visible in several scopes is the same function, a definition replaces declarations:
+		for (unsigned int i = inherited; i < candidates.size();) {
+			bool duplicate = false;
+			for (unsigned int j = 0; j < inherited; ++j) {
+				if (candidates[j]->mangle() == candidates[i]->mangle()) {
+					if (!candidates[j]->body && candidates[i]->body)
+						candidates[j] = candidates[i];
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate)
+				candidates.erase(candidates.begin() + i);
+			else
+				++i;
+		}
 	}
+
+	std::vector<Function*>& matches = resolvedCalls[call];
+	Functions::select(candidates, argTypes, matches);
+	return matches;
+}
+
+Function* juli::TypeInfo::resolveFunction(const Symbol& name, std::vector<const Type*>& argTypes,
+		const Indentable* astNode) const throw (CompilerError) {
+	const std::vector<Function*>& matches = findFunctions(name, argTypes);
 	if (matches.empty()) {
 		CompilerError err(astNode);
 		err.getStream() << "Undeclared function: " << name << " " << argTypes;
@@ -150,7 +217,7 @@ Function* juli::TypeInfo::resolveFunction(const std::string& name, std::vector<c
 		CompilerError err(astNode);
 		err.getStream() << "Ambiguous Function Call: " << name << "(" << argTypes << ")" << std::endl
 				<< "Candidates are: " << std::endl;
-		for (std::vector<Function*>::iterator i = matches.begin(); i != matches.end(); ++i) {
+		for (std::vector<Function*>::const_iterator i = matches.begin(); i != matches.end(); ++i) {
 			err.getStream() << *i << std::endl;
 		}
 
@@ -165,27 +232,57 @@ const Functions& juli::TypeInfo::getFunctions() const {
 
 const std::vector<Type*> juli::TypeInfo::getTypes() const {
 	std::vector<Type*> result;
-	for (std::map<std::string, Type*>::const_iterator i = typeTable.begin(); i != typeTable.end(); ++i) {
-		result.push_back(i->second);
+	for (std::vector<const TypeInfo*>::const_iterator s = scopes.begin(); s != scopes.end(); ++s) {
+		for (std::map<std::string, Type*>::const_iterator i = (*s)->typeTable.begin(); i != (*s)->typeTable.end();
+				++i) {
+			if (findType(i->first) == i->second)
+				result.push_back(i->second);
+		}
 	}
 	return result;
 }
 
+Type* juli::TypeInfo::findType(const std::string& name) const {
+	for (std::vector<const TypeInfo*>::const_iterator s = scopes.begin(); s != scopes.end(); ++s) {
+		std::map<std::string, Type*>::const_iterator i = (*s)->typeTable.find(name);
+		if (i != (*s)->typeTable.end())
+			return i->second;
+	}
+	return 0;
+}
+
 const Type* juli::TypeInfo::getType(const std::string& name, const Indentable* astNode) const throw (CompilerError) {
-	try {
-		return typeTable.at(name);
-	} catch (std::out_of_range& e) {
+	const Type* type = findType(name);
+	if (!type) {
 		CompilerError err(astNode);
 		err.getStream() << "Unknown type '" << name << "'";
 		throw err;
 	}
-	return 0;
+	return type;
 }
 
-void juli::TypeInfo::merge(const TypeInfo& other) {
-	functions.merge(other.functions);
-	mergeMaps(typeTable, other.typeTable);
-	mergeMaps(unresolvedTypes, other.unresolvedTypes);
+void juli::TypeInfo::addParent(const TypeInfo& parent) {
+	// the scopes the parent makes visible, each only once (e.g. modules imported by several imports):
+	std::vector<const TypeInfo*> added;
+	for (std::vector<const TypeInfo*>::const_iterator s = parent.scopes.begin(); s != parent.scopes.end(); ++s) {
+		if (std::find(scopes.begin(), scopes.end(), *s) == scopes.end())
+			added.push_back(*s);
+	}
+
+	for (std::vector<const TypeInfo*>::iterator s = added.begin(); s != added.end(); ++s) {
+		for (std::map<std::string, Type*>::const_iterator i = (*s)->typeTable.begin(); i != (*s)->typeTable.end();
+				++i) {
+			const Type* visible = findType(i->first);
+			if (visible && visible != i->second) {
+				ImportError err;
+				err.getStream() << "Multiply defined type " << i->first;
+				throw err;
+			}
+		}
+	}
+
+	scopes.insert(scopes.end(), added.begin(), added.end());
+	resolvedCalls.clear();
 }
 
 void juli::TypeInfo::dump() const {
@@ -8,8 +8,11 @@
 #ifndef TYPEINFO_H_
 #define TYPEINFO_H_
 
+#include <pthread.h>
+
 #include <map>
 #include <string>
+#include <vector>
 
 #include <parser/ast/types.h>
 #include <analysis/error.h>
@@ -19,37 +22,41 @@ namespace juli {
 
 class Functions;
 
+/*
+ * The types and functions visible in a module. A TypeInfo only holds what the module declares itself;
+ * the builtin scope (primitive types and implicit operators) and the TypeInfos of imported modules are
+ * linked as read-only parents and searched in order, instead of being copied into every importer.
+ *
+ * A TypeInfo must not be modified once it is linked into another one.
+ */
 class TypeInfo {
 private:
 
-	static std::map<std::string, Type*> implicitTypes;
+	static pthread_once_t builtinsOnce;
+	static TypeInfo* builtins;
+	static FunctionPool* builtinFunctions;
+
+	static void initBuiltins();
 
 	Functions functions;
 	std::map<std::string, Type*> typeTable;
 
 	std::map<std::string, const NClassDefinition*> unresolvedTypes;
 
-	template<class K, class V>
-	void mergeMaps(std::map<K, V>& first, const std::map<K, V>& second) {
-		typedef typename std::map<K, V>::const_iterator ConstIt;
-		typedef typename std::map<K, V>::const_iterator It;
+	// this TypeInfo and all the ones linked to it, each once, in the order they are searched:
+	std::vector<const TypeInfo*> scopes;
 
-//		std::cerr << "Merging: " << std::endl;
-//		std::cerr << first << std::endl;
-//		std::cerr << second << std::endl;
+	// resolved calls, until the next function or parent is added:
+	typedef std::pair<Symbol, std::vector<const Type*> > Call;
+	mutable std::map<Call, std::vector<Function*> > resolvedCalls;
 
-		for (ConstIt i = second.begin(); i != second.end(); ++i) {
-			std::pair<It, bool> res = first.insert(*i);
-			if (!res.second) {
-				if (implicitTypes.find(i->first) == implicitTypes.end()) {
-					ImportError err;
-					err.getStream() << "Multiply defined type " << i->first;
-					throw err;
-				}
-			}
-		}
+	TypeInfo(const TypeInfo& copy);
+	void operator=(const TypeInfo& copy);
 
-	}
+	// creates the builtin scope:
+	explicit TypeInfo(bool builtin);
+
+	Type* findType(const std::string& name) const;
 
 	void declareImplicitOperator(const std::vector<std::string> names, const Type* returnType, const Type* type,
 			unsigned int arity);
@@ -59,27 +66,54 @@ private:
 	void declareImplicitOperator(const std::string& name, const Type* type, unsigned int arity);
 public:
 
-	TypeInfo(bool implicit = true);
+	TypeInfo();
+
+	/*
+	 * Deletes the classes declared in this scope, which must not be used by any other TypeInfo anymore.
+	 */
+	~TypeInfo();
+
+	/*
+	 * The primitive types and implicit operators, shared by all TypeInfos.
+	 */
+	static const TypeInfo& getBuiltins();
 
 	void defineFunction(const NFunctionDefinition* f, bool importing);
 	void defineClass(const NClassDefinition* def);
 
 	void declareClass(const NClassDefinition* def);
 
+	/*
+	 * Takes ownership of the type, also if it is a redefinition.
+	 */
+	void declareClass(ClassType* type);
+
 	void resolveClasses();
 
 	void declareFunction(Function* f);
 
-	Function* resolveFunction(const std::string& name, std::vector<const Type*>& argTypes,
+	/*
+	 * The best matching functions visible in this scope (several if the call is ambiguous).
+	 */
+	const std::vector<Function*>& findFunctions(const Symbol& name, std::vector<const Type*>& argTypes) const;
+
+	Function* resolveFunction(const Symbol& name, std::vector<const Type*>& argTypes,
 			const Indentable* astNode) const throw (CompilerError);
 
+	/*
+	 * The functions declared in this scope (without its parents).
+	 */
 	const Functions& getFunctions() const;
 
 	const std::vector<Type*> getTypes() const;
 
 	const Type* getType(const std::string& name, const Indentable* astNode) const throw (CompilerError);
 
-	void merge(const TypeInfo& other);
+	/*
+	 * Makes the types and functions of an imported module visible. Throws an ImportError if it brings a
+	 * type that is already visible under the same name.
+	 */
+	void addParent(const TypeInfo& parent);
 
 	void dump() const;
 };
@@ -0,0 +1,362 @@
+#include "build.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <builder/hash.h>
+#include <builder/interface.h>
+#include <parser/ast/arena.h>
+
+using namespace juli;
+
+static bool hasExtension(const std::string& filename, const std::string& extension) {
+	return filename.size() > extension.size()
+			&& filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+juli::SourceModule::SourceModule() :
+		sourceTime(0), known(false), compiled(false) {
+}
+
+juli::BuildDriver::BuildDriver(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer,
+		const std::string& buildDir, unsigned int threads, const std::string& linker, ObjectCache* cache) :
+		emitter(emitter), arrayLayout(arrayLayout), importer(importer), cache(cache), buildDir(buildDir), threads(
+				threads), linker(linker) {
+}
+
+void juli::BuildDriver::add(const std::string& path) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		Error e;
+		e.getStream() << "No such file or directory: " << path;
+		throw e;
+	}
+
+	if (!S_ISDIR(st.st_mode)) {
+		addSource(path);
+		return;
+	}
+
+	DIR* dir = opendir(path.c_str());
+	if (!dir)
+		return;
+	while (struct dirent* entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		std::string child = path + "/" + name;
+		if (stat(child.c_str(), &st) != 0)
+			continue;
+		if (S_ISDIR(st.st_mode) || hasExtension(name, ".jl"))
+			add(child);
+	}
+	closedir(dir);
+}
+
+void juli::BuildDriver::addSource(const std::string& source) {
+	if (!hasExtension(source, ".jl")) {
+		Error e;
+		e.getStream() << "Not a juli source file: " << source;
+		throw e;
+	}
+
+	// modules are named like imports, relative to the working directory:
+	std::string name = source.substr(0, source.size() - 3);
+	while (name.compare(0, 2, "./") == 0)
+		name = name.substr(2);
+
+	// one object per module in the build directory, with '/' and the escape '%' percent-encoded so
+	// different modules (a/b, a_b, a%2Fb) never share an object:
+	std::string stem;
+	for (std::string::iterator i = name.begin(); i != name.end(); ++i) {
+		if (*i == '/')
+			stem += "%2F";
+		else if (*i == '%')
+			stem += "%25";
+		else
+			stem += *i;
+	}
+
+	SourceModule& module = modules[name];
+	module.name = name;
+	module.source = SourceImportLoader::getSourceFile(name);
+	module.object = buildDir + "/" + stem + ".o";
+	module.sourceTime = getModificationTime(module.source);
+}
+
+std::string juli::BuildDriver::getStateFile() const {
+	return buildDir + "/.jlc-build";
+}
+
+std::string juli::BuildDriver::getConfiguration() const {
+	std::stringstream s;
+	s << "-O" << emitter.getOptLevel() << " --array-layout="
+			<< ((arrayLayout == ARRAY_LAYOUT_INLINE) ? "inline" : "split");
+	return s.str();
+}
+
+/*
+ * The state file starts with the code generation options the objects were compiled with and then
+ * has one line per fact:
+ *
+ *   C <options>
+ *   S <module> <source time>
+ *   I <imported module>
+ *   D <module> <interface hash>
+ *
+ * where I and D lines belong to the last S line.
+ */
+void juli::BuildDriver::readState() {
+	std::ifstream is(getStateFile().c_str());
+	std::string line;
+	// objects compiled with other options are all compiled again:
+	if (!std::getline(is, line) || line != "C " + getConfiguration())
+		return;
+
+	SourceModule* current = 0;
+	while (std::getline(is, line)) {
+		std::stringstream s(line);
+		std::string kind;
+		s >> kind;
+		if (kind == "S") {
+			std::string name;
+			long long time;
+			s >> name >> time;
+			std::map<std::string, SourceModule>::iterator i = modules.find(name);
+			current = 0;
+			// a changed source has to be compiled and scanned anyway:
+			if (i != modules.end() && !s.fail() && (time_t) time == i->second.sourceTime) {
+				current = &i->second;
+				current->known = true;
+			}
+		} else if (kind == "I" && current) {
+			std::string name;
+			s >> name;
+			current->imports.push_back(name);
+		} else if (kind == "D" && current) {
+			std::string name;
+			std::string hash;
+			s >> name >> hash;
+			current->dependencies[name] = strtoull(hash.c_str(), 0, 16);
+		}
+	}
+}
+
+void juli::BuildDriver::writeState() const {
+	std::string filename = getStateFile();
+	std::string temporary = filename + ".tmp";
+	{
+		std::ofstream os(temporary.c_str());
+		os << "C " << getConfiguration() << std::endl;
+		for (std::map<std::string, SourceModule>::const_iterator i = modules.begin(); i != modules.end(); ++i) {
+			const SourceModule& module = i->second;
+			if (!module.known)
+				continue;
+			os << "S " << module.name << " " << (long long) module.sourceTime << std::endl;
+			for (std::vector<std::string>::const_iterator j = module.imports.begin(); j != module.imports.end();
+					++j) {
+				os << "I " << *j << std::endl;
+			}
+			for (std::map<std::string, uint64_t>::const_iterator j = module.dependencies.begin();
+					j != module.dependencies.end(); ++j) {
+				os << "D " << j->first << " " << std::hex << j->second << std::dec << std::endl;
+			}
+		}
+		if (!os)
+			return;
+	}
+	rename(temporary.c_str(), filename.c_str());
+}
+
+void juli::BuildDriver::scanImports(SourceModule& module) {
+	module.imports.clear();
+	AstArena arena;
+	AstArena::Scope arenaScope(arena);
+	NBlock* ast = parser.parse(module.source);
+	if (!ast) {
+		Error e;
+		e.getStream() << "Could not parse " << module.source;
+		throw e;
+	}
+	for (StatementList::iterator i = ast->statements.begin(); i != ast->statements.end(); ++i) {
+		if ((*i)->getType() == IMPORT)
+			module.imports.push_back(static_cast<NImportStatement*>(*i)->name->name);
+	}
+}
+
+uint64_t juli::BuildDriver::getInterfaceHash(const std::string& module) const {
+	uint64_t hash = ContentHash::ofFile(InterfaceFile::getFilename(module));
+	if (hash == 0) {
+		// a module outside of the build without interface, or a builtin module (0):
+		hash = ContentHash::ofFile(SourceImportLoader::getSourceFile(module));
+	}
+	return hash;
+}
+
+void juli::BuildDriver::collectDependencies(const std::string& module, std::set<std::string>& result) const {
+	std::map<std::string, SourceModule>::const_iterator i = modules.find(module);
+	if (i == modules.end())
+		return;
+	const std::vector<std::string>& imports = i->second.imports;
+	for (std::vector<std::string>::const_iterator j = imports.begin(); j != imports.end(); ++j) {
+		if (result.insert(*j).second)
+			collectDependencies(*j, result);
+	}
+}
+
+bool juli::BuildDriver::needsCompile(const SourceModule& module) const {
+	if (!module.known)
+		return true;
+	time_t objectTime = getModificationTime(module.object);
+	if (objectTime == 0 || objectTime < module.sourceTime)
+		return true;
+
+	std::set<std::string> dependencies;
+	collectDependencies(module.name, dependencies);
+	if (dependencies.size() != module.dependencies.size())
+		return true;
+	for (std::set<std::string>::iterator i = dependencies.begin(); i != dependencies.end(); ++i) {
+		std::map<std::string, uint64_t>::const_iterator recorded = module.dependencies.find(*i);
+		if (recorded == module.dependencies.end() || recorded->second != getInterfaceHash(*i))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * The level of a module is one more than the highest level of its imports in this build, so all
+ * modules of one level can be compiled in parallel once the previous levels are done.
+ */
+unsigned int juli::BuildDriver::getLevel(SourceModule& module, std::map<std::string, int>& levels) {
+	std::map<std::string, int>::iterator known = levels.find(module.name);
+	if (known != levels.end()) {
+		if (known->second < 0) {
+			Error e;
+			e.getStream() << "Import cycle involving module " << module.name;
+			throw e;
+		}
+		return known->second;
+	}
+
+	levels[module.name] = -1;
+	unsigned int level = 0;
+	for (std::vector<std::string>::iterator i = module.imports.begin(); i != module.imports.end(); ++i) {
+		std::map<std::string, SourceModule>::iterator imported = modules.find(*i);
+		if (imported != modules.end())
+			level = std::max(level, getLevel(imported->second, levels) + 1);
+	}
+	levels[module.name] = level;
+	return level;
+}
+
+std::vector<std::vector<SourceModule*> > juli::BuildDriver::getLevels() {
+	std::map<std::string, int> levels;
+	std::vector<std::vector<SourceModule*> > result;
+	for (std::map<std::string, SourceModule>::iterator i = modules.begin(); i != modules.end(); ++i) {
+		unsigned int level = getLevel(i->second, levels);
+		if (level >= result.size())
+			result.resize(level + 1);
+		result[level].push_back(&i->second);
+	}
+	return result;
+}
+
+int juli::BuildDriver::link(const std::string& output, std::ostream& diagnostics) const {
+	llvm::sys::Path program = llvm::sys::Program::FindProgramByName(linker);
+	if (program.isEmpty()) {
+		diagnostics << "Linker not found: " << linker << std::endl;
+		return 3;
+	}
+
+	std::vector<const char*> args;
+	args.push_back(linker.c_str());
+	args.push_back("-o");
+	args.push_back(output.c_str());
+	for (std::map<std::string, SourceModule>::const_iterator i = modules.begin(); i != modules.end(); ++i) {
+		args.push_back(i->second.object.c_str());
+	}
+	args.push_back("-lm");
+	args.push_back(0);
+
+	std::cout << "Linking " << output << std::endl;
+	std::string error;
+	int status = llvm::sys::Program::ExecuteAndWait(program, &args[0], 0, 0, 0, 0, &error);
+	if (status != 0) {
+		diagnostics << "Linking " << output << " failed" << (error.empty() ? "" : ": ") << error << std::endl;
+		return 3;
+	}
+	return 0;
+}
+
+int juli::BuildDriver::build(const std::string& output, std::ostream& diagnostics) {
+	readState();
+	for (std::map<std::string, SourceModule>::iterator i = modules.begin(); i != modules.end(); ++i) {
+		if (!i->second.known)
+			scanImports(i->second);
+	}
+
+	std::vector<std::vector<SourceModule*> > levels = getLevels();
+
+	int result = 0;
+	bool compiled = false;
+	for (std::vector<std::vector<SourceModule*> >::iterator level = levels.begin(); level != levels.end(); ++level) {
+		std::vector<CompileJob> jobs;
+		std::vector<SourceModule*> compiling;
+		for (std::vector<SourceModule*>::iterator i = level->begin(); i != level->end(); ++i) {
+			if (!needsCompile(**i))
+				continue;
+			CompileJob job;
+			job.inputFilename = (*i)->source;
+			job.outputFilename = (*i)->object;
+			job.outputInterfaceFilename = InterfaceFile::getFilename((*i)->name);
+			jobs.push_back(job);
+			compiling.push_back(*i);
+			std::cout << "Compiling " << (*i)->source << std::endl;
+		}
+		if (jobs.empty())
+			continue;
+
+		result = compileAll(emitter, arrayLayout, importer, jobs, threads, diagnostics, cache);
+		if (result != 0) {
+			// the state of the failed level is not recorded, so it is compiled again next time:
+			for (std::vector<SourceModule*>::iterator i = compiling.begin(); i != compiling.end(); ++i) {
+				(*i)->known = false;
+			}
+			break;
+		}
+
+		compiled = true;
+		for (std::vector<SourceModule*>::iterator i = compiling.begin(); i != compiling.end(); ++i) {
+			std::set<std::string> dependencies;
+			collectDependencies((*i)->name, dependencies);
+			(*i)->dependencies.clear();
+			for (std::set<std::string>::iterator j = dependencies.begin(); j != dependencies.end(); ++j) {
+				(*i)->dependencies[*j] = getInterfaceHash(*j);
+			}
+			(*i)->known = true;
+			(*i)->compiled = true;
+		}
+	}
+
+	writeState();
+	if (result != 0)
+		return result;
+
+	time_t outputTime = getModificationTime(output);
+	bool relink = compiled || outputTime == 0;
+	for (std::map<std::string, SourceModule>::iterator i = modules.begin(); !relink && i != modules.end(); ++i) {
+		relink = getModificationTime(i->second.object) > outputTime;
+	}
+	if (!relink) {
+		std::cout << output << " is up to date" << std::endl;
+		return 0;
+	}
+	return link(output, diagnostics);
+}
@@ -0,0 +1,97 @@
+/*
+ * build.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef BUILD_H_
+#define BUILD_H_
+
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+#include <builder/compiler.h>
+
+namespace juli {
+
+class SourceModule {
+public:
+	std::string name;
+	std::string source;
+	std::string object;
+
+	time_t sourceTime;
+	std::vector<std::string> imports;
+
+	// the interface hashes of all (transitively) imported modules the object was compiled against:
+	std::map<std::string, uint64_t> dependencies;
+
+	bool known;
+	bool compiled;
+
+	SourceModule();
+};
+
+/*
+ * Builds an executable from juli sources (jlc build): reads the imports of every source to order the
+ * compiles, recompiles only sources that changed or whose (transitively) imported interfaces changed,
+ * compiles independent sources in parallel and links the objects.
+ *
+ * What was compiled against what, and with which code generation options, is remembered in
+ * <build dir>/.jlc-build, so a build without changes only has to look at file times and interfaces.
+ */
+class BuildDriver {
+private:
+	CodeEmitter& emitter;
+	ArrayLayout arrayLayout;
+	Importer& importer;
+	ObjectCache* cache;
+
+	const std::string buildDir;
+	const unsigned int threads;
+	const std::string linker;
+
+	std::map<std::string, SourceModule> modules;
+
+	Parser parser;
+
+	std::string getStateFile() const;
+	std::string getConfiguration() const;
+	void readState();
+	void writeState() const;
+
+	void scanImports(SourceModule& module);
+
+	uint64_t getInterfaceHash(const std::string& module) const;
+	void collectDependencies(const std::string& module, std::set<std::string>& result) const;
+	bool needsCompile(const SourceModule& module) const;
+
+	std::vector<std::vector<SourceModule*> > getLevels();
+	unsigned int getLevel(SourceModule& module, std::map<std::string, int>& levels);
+
+	int link(const std::string& output, std::ostream& diagnostics) const;
+public:
+	BuildDriver(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer, const std::string& buildDir,
+			unsigned int threads, const std::string& linker, ObjectCache* cache = 0);
+
+	/*
+	 * Adds a source file, or all sources in a directory (recursively).
+	 */
+	void add(const std::string& path);
+
+	void addSource(const std::string& source);
+
+	/*
+	 * Returns 0 on success, the compile status or 3 if linking failed.
+	 */
+	int build(const std::string& output, std::ostream& diagnostics);
+};
+
+}
+
+#endif /* BUILD_H_ */
@@ -1,15 +1,90 @@
 #include "builder.h"
 
+#include <sstream>
+
+#include <profile/profiler.h>
+
+#include <sys/stat.h>
+
 using namespace juli;
 
-juli::SourceImportLoader::SourceImportLoader(Parser& parser, Importer& parent) :
-		parser(parser), parent(parent) {
+juli::SourceImportLoader::SourceImportLoader(Importer& parent) :
+		parent(parent) {
+}
+
+juli::SourceImportLoader::~SourceImportLoader() {
+	for (std::map<std::string, AstArena*>::iterator i = arenas.begin(); i != arenas.end(); ++i) {
+		delete i->second;
+	}
+}
+
+std::string juli::SourceImportLoader::getSourceFile(const std::string& module) {
+	return module + ".jl";
+}
+
+time_t juli::getModificationTime(const std::string& filename) {
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+		return 0;
+	return st.st_mtime;
+}
+
+juli::FileStamp::FileStamp() :
+		device(0), inode(0), size(0), seconds(0), nanoseconds(0) {
+}
+
+FileStamp juli::FileStamp::of(const std::string& filename) {
+	FileStamp stamp;
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+		return stamp;
+	stamp.device = st.st_dev;
+	stamp.inode = st.st_ino;
+	stamp.size = st.st_size;
+	stamp.seconds = st.st_mtim.tv_sec;
+	stamp.nanoseconds = st.st_mtim.tv_nsec;
+	return stamp;
+}
+
+bool juli::FileStamp::operator==(const FileStamp& other) const {
+	return device == other.device && inode == other.inode && size == other.size && seconds == other.seconds
+			&& nanoseconds == other.nanoseconds;
+}
+
+bool juli::FileStamp::operator!=(const FileStamp& other) const {
+	return !(*this == other);
+}
+
+bool juli::SourceImportLoader::isUpToDate(const std::string& module) const {
+	std::map<std::string, FileStamp>::const_iterator i = stamps.find(module);
+	return i != stamps.end() && i->second == FileStamp::of(getSourceFile(module));
+}
+
+std::string juli::SourceImportLoader::getFilename(const std::string& module) const {
+	return getSourceFile(module);
 }
 
 TypeInfo* juli::SourceImportLoader::importTypes(const std::string& module) {
+	// a module is only loaded again after the importer dropped its previous types:
+	AstArena*& arena = arenas[module];
+	delete arena;
+	arena = new AstArena();
+	AstArena::Scope arenaScope(*arena);
+
 	Declarator declarator(parent, true);
 	try {
-		return declarator.declare(parser.parse(module + ".jl"));
+		stamps[module] = FileStamp::of(getSourceFile(module));
+		NBlock* ast = parser.parse(getSourceFile(module));
+		if (!ast)
+			return 0;
+		TypeInfo* typeInfo = declarator.declare(ast);
+		try {
+			typeInfo->resolveClasses();
+		} catch (...) {
+			delete typeInfo;
+			throw;
+		}
+		return typeInfo;
 	} catch (CompilerError& e) {
 		throw e;
 	} catch (...) {
@@ -17,7 +92,92 @@ TypeInfo* juli::SourceImportLoader::importTypes(const std::string& module) {
 	return 0;
 }
 
+void juli::BuiltinImportLoader::declareMathFunction(TypeInfo* typeInfo, const std::string& name,
+		unsigned int arity) {
+	std::vector<FormalParameter> args;
+	for (unsigned int i = 0; i < arity; ++i) {
+		std::stringstream s;
+		s << "x" << i;
+		args.push_back(FormalParameter(&PrimitiveType::FLOAT64_TYPE, s.str()));
+	}
+	typeInfo->declareFunction(Function::get(name, &PrimitiveType::FLOAT64_TYPE, args, false, MODIFIER_C));
+}
+
+TypeInfo* juli::BuiltinImportLoader::importTypes(const std::string& module) {
+	if (module != "math")
+		return 0;
+
+	TypeInfo* typeInfo = new TypeInfo();
+	declareMathFunction(typeInfo, "sqrt", 1);
+	declareMathFunction(typeInfo, "fabs", 1);
+	declareMathFunction(typeInfo, "floor", 1);
+	declareMathFunction(typeInfo, "ceil", 1);
+	declareMathFunction(typeInfo, "exp", 1);
+	declareMathFunction(typeInfo, "log", 1);
+	declareMathFunction(typeInfo, "pow", 2);
+	declareMathFunction(typeInfo, "fmin", 2);
+	declareMathFunction(typeInfo, "fmax", 2);
+	declareMathFunction(typeInfo, "fma", 3);
+	return typeInfo;
+}
+
 juli::Importer::Importer() {
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+}
+
+const FunctionPool& juli::Importer::getFunctionPool() const {
+	return functions;
+}
+
+void juli::Importer::collectImports(const std::string& module, std::set<std::string>& result) {
+	pthread_mutex_lock(&mutex);
+	std::map<std::string, std::vector<std::string> >::iterator i = imports.find(module);
+	if (i != imports.end()) {
+		for (std::vector<std::string>::iterator j = i->second.begin(); j != i->second.end(); ++j) {
+			if (result.insert(*j).second)
+				collectImports(*j, result);
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+std::string juli::Importer::getFilename(const std::string& module) {
+	pthread_mutex_lock(&mutex);
+	std::map<std::string, const ImportLoader*>::iterator i = origins.find(module);
+	std::string result = (i == origins.end()) ? "" : i->second->getFilename(module);
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+bool juli::Importer::refresh() {
+	bool outdated = false;
+	pthread_mutex_lock(&mutex);
+	for (std::map<std::string, const ImportLoader*>::iterator i = origins.begin(); i != origins.end(); ++i) {
+		if (!i->second->isUpToDate(i->first)) {
+			outdated = true;
+			break;
+		}
+	}
+	if (outdated)
+		clear();
+	pthread_mutex_unlock(&mutex);
+	return outdated;
+}
+
+void juli::Importer::clear() {
+	pthread_mutex_lock(&mutex);
+	for (std::map<std::string, TypeInfo*>::iterator i = cache.begin(); i != cache.end(); ++i) {
+		delete i->second;
+	}
+	cache.clear();
+	origins.clear();
+	imports.clear();
+	functions.clear();
+	pthread_mutex_unlock(&mutex);
 }
 
 void juli::Importer::add(ImportLoader* loader) {
@@ -29,23 +189,41 @@ juli::Importer::~Importer() {
 		delete *i;
 	}
 
-	for (std::map<std::string, TypeInfo*>::iterator i = cache.begin(); i != cache.end(); ++i) {
-		delete i->second;
-	}
+	clear();
+	pthread_mutex_destroy(&mutex);
 }
 
 TypeInfo& juli::Importer::getTypes(const std::string& module) {
+	pthread_mutex_lock(&mutex);
+	if (!loading.empty())
+		imports[loading.back()].push_back(module);
 	TypeInfo* & ti = cache[module];
 	if (!ti) {
+		// imported declarations belong to the importer, not to the compilation that triggered the import:
+		FunctionPool::Scope scope(functions);
 		std::vector<ImportLoader*>::iterator loaderIt = loaders.begin();
-		while (loaderIt != loaders.end() && !(ti = (*loaderIt)->importTypes(module))) {
-			++loaderIt;
+		imports[module].clear();
+		loading.push_back(module);
+		ProfileScope profile("import", module);
+		try {
+			while (loaderIt != loaders.end() && !(ti = (*loaderIt)->importTypes(module))) {
+				++loaderIt;
+			}
+		} catch (...) {
+			loading.pop_back();
+			pthread_mutex_unlock(&mutex);
+			throw;
 		}
+		loading.pop_back();
 		if (!ti) {
+			pthread_mutex_unlock(&mutex);
 			ImportError err;
 			err.getStream() << "Could not load module " << module;
 			throw err;
 		}
+		origins[module] = *loaderIt;
 	}
-	return *ti;
+	TypeInfo& result = *ti;
+	pthread_mutex_unlock(&mutex);
+	return result;
 }
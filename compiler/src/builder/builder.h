@@ -11,11 +11,44 @@
 #include <analysis/type/typeinfo.h>
 #include <analysis/type/declare.h>
 #include <parser/parser.h>
+#include <parser/ast/arena.h>
+
+#include <ctime>
+#include <set>
+#include <pthread.h>
+#include <sys/types.h>
 
 namespace juli {
 
 class Declarator;
 
+/*
+ * Returns 0 if the file does not exist.
+ */
+time_t getModificationTime(const std::string& filename);
+
+/*
+ * Identifies one version of a file: the file itself (device and inode), its size and its modification
+ * time in nanoseconds, so a different file with the same name and time does not pass for it. All zero
+ * if the file does not exist.
+ */
+class FileStamp {
+public:
+	dev_t device;
+	ino_t inode;
+	off_t size;
+	time_t seconds;
+	long nanoseconds;
+
+	FileStamp();
+
+	static FileStamp of(const std::string& filename);
+
+	bool operator==(const FileStamp& other) const;
+
+	bool operator!=(const FileStamp& other) const;
+};
+
 class ImportLoader {
 private:
 public:
@@ -23,12 +56,46 @@ public:
 	}
 
 	virtual TypeInfo* importTypes(const std::string& module) = 0;
+
+	/*
+	 * Whether the types this loader returned for module are still valid (e.g. the source did not change).
+	 */
+	virtual bool isUpToDate(const std::string& module) const {
+		return true;
+	}
+
+	/*
+	 * The file the types of module were read from, empty if the module is not read from a file.
+	 */
+	virtual std::string getFilename(const std::string& module) const {
+		return "";
+	}
 };
 
+/*
+ * Loads and caches the types of imported modules. The functions declared by imported modules live in
+ * the importer's function pool, so the cache can outlive a single compilation.
+ *
+ * One importer may be shared by concurrent compilations: modules are loaded one at a time, and the
+ * cached types are never modified after loading.
+ */
 class Importer {
 private:
 	std::map<std::string, TypeInfo*> cache;
+	std::map<std::string, const ImportLoader*> origins;
 	std::vector<ImportLoader*> loaders;
+
+	// the modules imported by each loaded module, and the modules currently being loaded:
+	std::map<std::string, std::vector<std::string> > imports;
+	std::vector<std::string> loading;
+
+	FunctionPool functions;
+
+	// recursive, loading a module imports its dependencies:
+	pthread_mutex_t mutex;
+
+	Importer(const Importer& copy);
+	void operator=(const Importer& copy);
 public:
 	Importer();
 	~Importer();
@@ -36,16 +103,64 @@ public:
 	void add(ImportLoader* loader);
 
 	TypeInfo& getTypes(const std::string& module);
+
+	const FunctionPool& getFunctionPool() const;
+
+	/*
+	 * Adds all modules the (loaded) module imports, directly or indirectly, to result.
+	 */
+	void collectImports(const std::string& module, std::set<std::string>& result);
+
+	/*
+	 * The file the (loaded) module was read from, empty for builtin modules.
+	 */
+	std::string getFilename(const std::string& module);
+
+	/*
+	 * Drops all cached modules if one of them is out of date, as the others may depend on it.
+	 * Returns true if the cache was dropped.
+	 */
+	bool refresh();
+
+	void clear();
+};
+
+/*
+ * Provides modules that are built into the compiler instead of being read from source files.
+ *
+ * math: C double sqrt(double), fabs, floor, ceil, exp, log (double), pow, fmin, fmax (double, double)
+ *       and fma (double, double, double). Calls to these are lowered to LLVM intrinsics (ceil to
+ *       -floor(-x)), except for negative or NaN inputs of sqrt, which call libm, and fmin and fmax, which
+ *       become a NaN-aware compare and select.
+ */
+class BuiltinImportLoader : public ImportLoader {
+private:
+	void declareMathFunction(TypeInfo* typeInfo, const std::string& name, unsigned int arity);
+public:
+	virtual TypeInfo* importTypes(const std::string& module);
 };
 
 class SourceImportLoader : public ImportLoader {
 private:
-	Parser& parser;
+	Parser parser;
 	Importer& parent;
+
+	std::map<std::string, FileStamp> stamps;
+
+	// the asts of the imported modules, as their types and errors refer to them:
+	std::map<std::string, AstArena*> arenas;
 public:
-	SourceImportLoader(Parser& parser, Importer& parent);
+	SourceImportLoader(Importer& parent);
+
+	~SourceImportLoader();
+
+	static std::string getSourceFile(const std::string& module);
 
 	virtual TypeInfo* importTypes(const std::string& module);
+
+	virtual bool isUpToDate(const std::string& module) const;
+
+	virtual std::string getFilename(const std::string& module) const;
 };
 
 }
@@ -0,0 +1,156 @@
+#include "cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+using namespace juli;
+
+static void createDirectory(const std::string& directory) {
+	size_t slash = directory.rfind('/');
+	if (slash != std::string::npos && slash > 0)
+		createDirectory(directory.substr(0, slash));
+	mkdir(directory.c_str(), 0777);
+}
+
+static bool copyFile(const std::string& from, const std::string& to) {
+	std::ifstream is(from.c_str(), std::ios::in | std::ios::binary);
+	if (!is)
+		return false;
+	std::ofstream os(to.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	os << is.rdbuf();
+	os.close();
+	return !os.fail();
+}
+
+juli::ObjectCache::ObjectCache(const std::string& directory, uint64_t maxSize) :
+		directory(directory), maxSize(maxSize), hits(0), misses(0), stores(0), evictions(0), temporaries(0), size(0), sized(
+				false) {
+	pthread_mutex_init(&mutex, 0);
+	createDirectory(directory);
+}
+
+juli::ObjectCache::~ObjectCache() {
+	pthread_mutex_destroy(&mutex);
+}
+
+std::string juli::ObjectCache::getPath(const ContentHash& key) const {
+	return directory + "/" + key.toString() + ".o";
+}
+
+std::string juli::ObjectCache::getTemporary(const std::string& filename) {
+	pthread_mutex_lock(&mutex);
+	std::stringstream s;
+	s << filename << "." << getpid() << "." << temporaries++ << ".tmp";
+	pthread_mutex_unlock(&mutex);
+	return s.str();
+}
+
+bool juli::ObjectCache::fetch(const ContentHash& key, const std::string& filename) {
+	std::string path = getPath(key);
+	std::string temporary = getTemporary(filename);
+	bool hit = copyFile(path, temporary) && rename(temporary.c_str(), filename.c_str()) == 0;
+	if (hit) {
+		// the modification time orders the entries for eviction:
+		utime(path.c_str(), 0);
+	} else {
+		remove(temporary.c_str());
+	}
+
+	pthread_mutex_lock(&mutex);
+	if (hit)
+		++hits;
+	else
+		++misses;
+	pthread_mutex_unlock(&mutex);
+	return hit;
+}
+
+void juli::ObjectCache::store(const ContentHash& key, const std::string& filename) {
+	std::string path = getPath(key);
+	std::string temporary = getTemporary(path);
+	if (!copyFile(filename, temporary) || rename(temporary.c_str(), path.c_str()) != 0) {
+		remove(temporary.c_str());
+		return;
+	}
+	struct stat st;
+	uint64_t stored = (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+
+	pthread_mutex_lock(&mutex);
+	++stores;
+	size += stored;
+	if (!sized || size > maxSize)
+		evict();
+	pthread_mutex_unlock(&mutex);
+}
+
+class CacheEntry {
+public:
+	time_t time;
+	uint64_t size;
+	std::string path;
+
+	CacheEntry(time_t time, uint64_t size, const std::string& path) :
+			time(time), size(size), path(path) {
+	}
+
+	bool operator<(const CacheEntry& other) const {
+		return time < other.time;
+	}
+};
+
+/*
+ * Recounts the size of the entries and, if they exceed the maximum size, removes the least recently
+ * used until they take 90% of it. Called with the mutex held.
+ */
+void juli::ObjectCache::evict() {
+	DIR* dir = opendir(directory.c_str());
+	if (!dir)
+		return;
+
+	std::vector<CacheEntry> entries;
+	size = 0;
+	sized = true;
+	while (struct dirent* entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if (name.size() < 2 || name.compare(name.size() - 2, 2, ".o") != 0)
+			continue;
+		std::string path = directory + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0)
+			continue;
+		entries.push_back(CacheEntry(st.st_mtime, st.st_size, path));
+		size += st.st_size;
+	}
+	closedir(dir);
+
+	if (size <= maxSize)
+		return;
+
+	// leave room, so the next stores do not scan the directory again right away:
+	uint64_t target = maxSize - maxSize / 10;
+	std::sort(entries.begin(), entries.end());
+	for (std::vector<CacheEntry>::iterator i = entries.begin(); i != entries.end() && size > target; ++i) {
+		// another process may have removed it already:
+		if (remove(i->path.c_str()) == 0)
+			++evictions;
+		size -= i->size;
+	}
+}
+
+void juli::ObjectCache::printStatistics(std::ostream& os) {
+	pthread_mutex_lock(&mutex);
+	unsigned int lookups = hits + misses;
+	os << "object cache " << directory << ": " << hits << " hits, " << misses << " misses";
+	if (lookups > 0)
+		os << " (" << (100 * hits / lookups) << "% hit rate)";
+	os << ", " << stores << " stored, " << evictions << " evicted" << std::endl;
+	pthread_mutex_unlock(&mutex);
+}
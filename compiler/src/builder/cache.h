@@ -0,0 +1,71 @@
+/*
+ * cache.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <builder/hash.h>
+
+namespace juli {
+
+/*
+ * Objects addressed by the hash of everything that went into compiling them (see Compiler), so
+ * compiling the same source against the same interfaces for the same target can reuse the object.
+ *
+ * Entries are <directory>/<hash>.o, written to a temporary file and renamed, so several processes may
+ * share the directory. When the entries exceed the maximum size, the least recently used are removed
+ * until they take 90% of it. The size is counted up as objects are stored and the directory is only
+ * scanned on the first store and when the count exceeds the maximum, which also picks up the entries
+ * other processes stored.
+ */
+class ObjectCache {
+private:
+	const std::string directory;
+	const uint64_t maxSize;
+
+	pthread_mutex_t mutex;
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int stores;
+	unsigned int evictions;
+	unsigned int temporaries;
+
+	// the size of the entries, known after the first store:
+	uint64_t size;
+	bool sized;
+
+	ObjectCache(const ObjectCache& copy);
+	void operator=(const ObjectCache& copy);
+
+	std::string getPath(const ContentHash& key) const;
+	std::string getTemporary(const std::string& filename);
+
+	void evict();
+public:
+	ObjectCache(const std::string& directory, uint64_t maxSize);
+	~ObjectCache();
+
+	/*
+	 * Copies the object cached for key to filename. Returns false if there is none.
+	 */
+	bool fetch(const ContentHash& key, const std::string& filename);
+
+	/*
+	 * Copies the object in filename to the cache.
+	 */
+	void store(const ContentHash& key, const std::string& filename);
+
+	void printStatistics(std::ostream& os);
+};
+
+}
+
+#endif /* CACHE_H_ */
@@ -0,0 +1,274 @@
+#include "compiler.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include <pthread.h>
+
+#include <analysis/type/declare.h>
+#include <analysis/type/names.h>
+#include <analysis/type/typecheck.h>
+#include <codegen/llvm/ir.h>
+#include <parser/ast/arena.h>
+#include <builder/interface.h>
+#include <profile/profiler.h>
+
+#include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Support/Threading.h>
+
+using namespace juli;
+
+static pthread_once_t buildIdOnce = PTHREAD_ONCE_INIT;
+static uint64_t buildId;
+
+static void initBuildId() {
+	buildId = ContentHash::ofFile("/proc/self/exe");
+	if (buildId == 0) {
+		// without access to the binary, at least tell apart compilers built at different times:
+		buildId = ContentHash().add(__DATE__ " " __TIME__).get();
+	}
+}
+
+/*
+ * The hash of the running compiler binary, so objects cached by other compilers are not reused.
+ */
+static uint64_t getBuildId() {
+	pthread_once(&buildIdOnce, initBuildId);
+	return buildId;
+}
+
+juli::Compiler::Compiler(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer, ObjectCache* cache) :
+		emitter(emitter), arrayLayout(arrayLayout), machine(CodeEmitter::getNativeMachine(emitter.getOptLevel())), importer(
+				importer), cache(cache) {
+}
+
+void juli::Compiler::initImporter(Importer& importer) {
+	importer.add(new BuiltinImportLoader());
+	importer.add(new InterfaceImportLoader(importer));
+	importer.add(new SourceImportLoader(importer));
+}
+
+juli::Compiler::~Compiler() {
+	delete machine;
+}
+
+Importer& juli::Compiler::getImporter() {
+	return importer;
+}
+
+ContentHash juli::Compiler::getCacheKey(const CompileJob& job, const NBlock* ast) {
+	ContentHash key;
+
+	std::stringstream configuration;
+	configuration << "jlc " << std::hex << getBuildId() << std::dec << " " << machine->getTargetTriple().str() << " "
+			<< machine->getTargetCPU().str() << " -O" << emitter.getOptLevel() << " " << arrayLayout;
+	key.add(configuration.str());
+
+	uint64_t source = ContentHash::ofFile(job.inputFilename);
+	key.add((const char*) &source, sizeof(source));
+
+	// the contents of all interfaces the module is compiled against, in a fixed order:
+	std::set<std::string> modules;
+	for (StatementList::const_iterator i = ast->statements.begin(); i != ast->statements.end(); ++i) {
+		if ((*i)->getType() == IMPORT) {
+			const std::string& module = static_cast<const NImportStatement*>(*i)->name->name;
+			modules.insert(module);
+			importer.collectImports(module, modules);
+		}
+	}
+	for (std::set<std::string>::iterator i = modules.begin(); i != modules.end(); ++i) {
+		std::string filename = importer.getFilename(*i);
+		uint64_t contents = filename.empty() ? 0 : ContentHash::ofFile(filename);
+		key.add(*i);
+		key.add((const char*) &contents, sizeof(contents));
+	}
+	return key;
+}
+
+int juli::Compiler::compile(const CompileJob& job, std::ostream& diagnostics) {
+	int result = 0;
+
+	// the ast, and everything referring to it, lives as long as this compilation:
+	AstArena arena;
+	AstArena::Scope arenaScope(arena);
+	FunctionPool functions(&importer.getFunctionPool());
+	FunctionPool::Scope scope(functions);
+	ProfileScope profileFile("file", job.inputFilename);
+	TypeInfo* typeInfo = 0;
+	try {
+		NBlock* ast;
+		{
+			ProfileScope profile("phase", "parse");
+			if (Parser::isComparing())
+				return parser.compare(job.inputFilename) ? 0 : 3;
+			ast = parser.parse(job.inputFilename);
+		}
+		if (!ast) {
+			diagnostics << "Could not parse " << job.inputFilename << std::endl;
+			return 2;
+		}
+
+		{
+			// includes loading the imported modules:
+			ProfileScope profile("phase", "declare");
+			Declarator declarator(importer);
+			typeInfo = declarator.declare(ast);
+		}
+		{
+			ProfileScope profile("phase", "resolveClasses");
+			typeInfo->resolveClasses();
+		}
+
+		{
+			ProfileScope profile("phase", "resolveNames");
+			NameResolver resolver;
+			resolver.resolve(ast);
+		}
+
+		{
+			ProfileScope profile("phase", "typecheck");
+			TypeChecker typeChecker(*typeInfo);
+			typeChecker.visit(ast);
+		}
+
+		if (!job.outputASTFilename.empty()) {
+			std::ofstream astos(job.outputASTFilename.c_str());
+			ast->print(astos, 0, Indentable::FLAG_TREE);
+		}
+
+		ContentHash key;
+		bool cached = false;
+		if (cache) {
+			ProfileScope profile("phase", "cache");
+			key = getCacheKey(job, ast);
+			// the IR is only available if it is generated:
+			if (job.outputIRFilename.empty())
+				cached = cache->fetch(key, job.outputFilename);
+		}
+
+		if (cached) {
+			if (!job.outputInterfaceFilename.empty())
+				InterfaceFile::write(job.outputInterfaceFilename, ast, *typeInfo);
+		} else {
+			IRGenerator irgen("test", *typeInfo, arrayLayout);
+			{
+				ProfileScope profile("phase", "irgen");
+				irgen.process(ast);
+			}
+
+			if (!job.outputIRFilename.empty()) {
+				std::ofstream iros(job.outputIRFilename.c_str());
+				llvm::raw_os_ostream ros(iros);
+				irgen.getTranslationUnit().module->print(ros, 0);
+			}
+
+			if (irgen.getTranslationUnit().getErrors().empty()) {
+				bool emitted;
+				{
+					ProfileScope profile("phase", "emit");
+					emitted = emitter.emitCode(job.outputFilename.c_str(), irgen.getTranslationUnit().module, machine);
+				}
+				if (emitted) {
+					if (cache)
+						cache->store(key, job.outputFilename);
+				} else {
+					diagnostics << "Could not write " << job.outputFilename << std::endl;
+					result = 2;
+				}
+				if (!job.outputInterfaceFilename.empty()) {
+					InterfaceFile::write(job.outputInterfaceFilename, ast, *typeInfo);
+				}
+			} else {
+				std::vector<CompilerError> errors = irgen.getTranslationUnit().getErrors();
+				for (std::vector<CompilerError>::iterator i = errors.begin(); i != errors.end(); ++i) {
+					diagnostics << *i;
+				}
+				result = 1;
+			}
+		}
+
+	} catch (Error& ce) {
+		diagnostics << "Uncaught error: " << ce;
+		result = 2;
+	}
+	delete typeInfo;
+	return result;
+}
+
+class CompileQueue {
+public:
+	CodeEmitter& emitter;
+	ArrayLayout arrayLayout;
+	Importer& importer;
+	ObjectCache* cache;
+	const std::vector<CompileJob>& jobs;
+
+	std::vector<int> results;
+	std::vector<std::string> diagnostics;
+
+	pthread_mutex_t mutex;
+	unsigned int next;
+
+	CompileQueue(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer, ObjectCache* cache,
+			const std::vector<CompileJob>& jobs) :
+			emitter(emitter), arrayLayout(arrayLayout), importer(importer), cache(cache), jobs(jobs), results(jobs.size(), 0), diagnostics(
+					jobs.size()), next(0) {
+		pthread_mutex_init(&mutex, 0);
+	}
+
+	~CompileQueue() {
+		pthread_mutex_destroy(&mutex);
+	}
+
+	bool take(unsigned int& job) {
+		pthread_mutex_lock(&mutex);
+		job = next;
+		if (next < jobs.size())
+			++next;
+		pthread_mutex_unlock(&mutex);
+		return job < jobs.size();
+	}
+};
+
+static void* compileWorker(void* arg) {
+	CompileQueue* queue = static_cast<CompileQueue*>(arg);
+	Compiler compiler(queue->emitter, queue->arrayLayout, queue->importer, queue->cache);
+	unsigned int job;
+	while (queue->take(job)) {
+		std::stringstream diagnostics;
+		queue->results[job] = compiler.compile(queue->jobs[job], diagnostics);
+		queue->diagnostics[job] = diagnostics.str();
+	}
+	return 0;
+}
+
+int juli::compileAll(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer,
+		const std::vector<CompileJob>& jobs, unsigned int threads, std::ostream& diagnostics, ObjectCache* cache) {
+	CompileQueue queue(emitter, arrayLayout, importer, cache, jobs);
+
+	if (threads > jobs.size())
+		threads = jobs.size();
+	if (threads > 1)
+		llvm::llvm_start_multithreaded();
+
+	std::vector<pthread_t> workers;
+	for (unsigned int i = 1; i < threads; ++i) {
+		pthread_t worker;
+		if (pthread_create(&worker, 0, compileWorker, &queue) == 0)
+			workers.push_back(worker);
+	}
+	// the calling thread works as well, so there is progress even if no thread could be started:
+	compileWorker(&queue);
+	for (std::vector<pthread_t>::iterator i = workers.begin(); i != workers.end(); ++i) {
+		pthread_join(*i, 0);
+	}
+
+	int result = 0;
+	for (unsigned int i = 0; i < jobs.size(); ++i) {
+		diagnostics << queue.diagnostics[i];
+		if (queue.results[i] > result)
+			result = queue.results[i];
+	}
+	return result;
+}
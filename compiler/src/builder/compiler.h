@@ -0,0 +1,87 @@
+/*
+ * compiler.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef COMPILER_H_
+#define COMPILER_H_
+
+#include <string>
+#include <ostream>
+#include <vector>
+
+#include <builder/builder.h>
+#include <builder/cache.h>
+#include <codegen/llvm/native.h>
+#include <codegen/llvm/translationUnit.h>
+#include <parser/parser.h>
+
+namespace juli {
+
+class CompileJob {
+public:
+	std::string inputFilename;
+	std::string outputFilename;
+	std::string outputIRFilename;
+	std::string outputASTFilename;
+	std::string outputInterfaceFilename;
+};
+
+/*
+ * Compiles single source files to objects. The target machine and the imported modules are kept
+ * between compilations, everything else is created per compilation.
+ *
+ * A compiler must only be used by one thread at a time, but several compilers may share an importer.
+ */
+class Compiler {
+private:
+	CodeEmitter& emitter;
+	ArrayLayout arrayLayout;
+	llvm::TargetMachine* machine;
+
+	Parser parser;
+	Importer& importer;
+	ObjectCache* cache;
+
+	/*
+	 * The hash of everything the object of the (declared) module depends on: the source, the contents
+	 * of all interfaces it imports (directly or indirectly), the compiler binary, the target and the code
+	 * generation options.
+	 */
+	ContentHash getCacheKey(const CompileJob& job, const NBlock* ast);
+
+	Compiler(const Compiler& copy);
+	void operator=(const Compiler& copy);
+public:
+	/*
+	 * If a cache is given, objects are reused from and added to it.
+	 */
+	Compiler(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer, ObjectCache* cache = 0);
+
+	~Compiler();
+
+	/*
+	 * Adds the builtin, interface and source loaders, in that order.
+	 */
+	static void initImporter(Importer& importer);
+
+	Importer& getImporter();
+
+	/*
+	 * Returns 0 on success, 1 on compile errors and 2 on internal errors. Diagnostics are written to
+	 * the given stream. With --parser=compare nothing is compiled, 3 is returned if the parsers disagree.
+	 */
+	int compile(const CompileJob& job, std::ostream& diagnostics);
+};
+
+/*
+ * Compiles the jobs on up to the given number of threads. Each thread has its own compiler, the
+ * importer is shared. The diagnostics are written in the order of the jobs, the worst status is returned.
+ */
+int compileAll(CodeEmitter& emitter, ArrayLayout arrayLayout, Importer& importer, const std::vector<CompileJob>& jobs,
+		unsigned int threads, std::ostream& diagnostics, ObjectCache* cache = 0);
+
+}
+
+#endif /* COMPILER_H_ */
@@ -0,0 +1,47 @@
+#include "hash.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace juli;
+
+juli::ContentHash::ContentHash() :
+		value(14695981039346656037ULL) {
+}
+
+ContentHash& juli::ContentHash::add(const char* data, size_t size) {
+	for (size_t i = 0; i < size; ++i) {
+		value ^= (unsigned char) data[i];
+		value *= 1099511628211ULL;
+	}
+	return *this;
+}
+
+ContentHash& juli::ContentHash::add(const std::string& data) {
+	// include the length, so consecutive strings can't be shifted against each other:
+	uint64_t length = data.size();
+	add((const char*) &length, sizeof(length));
+	return add(data.data(), data.size());
+}
+
+uint64_t juli::ContentHash::get() const {
+	return value;
+}
+
+std::string juli::ContentHash::toString() const {
+	char buffer[17];
+	snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long) value);
+	return buffer;
+}
+
+uint64_t juli::ContentHash::ofFile(const std::string& filename) {
+	std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!is)
+		return 0;
+	ContentHash hash;
+	char buffer[4096];
+	while (is.read(buffer, sizeof(buffer)) || is.gcount() > 0) {
+		hash.add(buffer, is.gcount());
+	}
+	return hash.get();
+}
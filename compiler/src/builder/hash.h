@@ -0,0 +1,40 @@
+/*
+ * hash.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <string>
+#include <stdint.h>
+
+namespace juli {
+
+/*
+ * 64 bit FNV-1a hash, to detect changed file contents.
+ */
+class ContentHash {
+private:
+	uint64_t value;
+public:
+	ContentHash();
+
+	ContentHash& add(const char* data, size_t size);
+
+	ContentHash& add(const std::string& data);
+
+	uint64_t get() const;
+
+	std::string toString() const;
+
+	/*
+	 * The hash of the file's contents, 0 if it can't be read.
+	 */
+	static uint64_t ofFile(const std::string& filename);
+};
+
+}
+
+#endif /* HASH_H_ */
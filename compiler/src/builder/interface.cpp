@@ -0,0 +1,317 @@
+#include "interface.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace juli;
+
+const char juli::InterfaceFile::MAGIC[4] = { 'J', 'L', 'I', 0 };
+const unsigned int juli::InterfaceFile::VERSION = 1;
+
+enum TypeTag {
+	TAG_PRIMITIVE, TAG_REFERENCE, TAG_ARRAY, TAG_CLASS
+};
+
+class InterfaceWriter {
+private:
+	std::ostream& os;
+public:
+	InterfaceWriter(std::ostream& os) :
+			os(os) {
+	}
+
+	void u8(unsigned char value) {
+		os.put(value);
+	}
+
+	void u32(uint32_t value) {
+		for (int i = 0; i < 4; ++i) {
+			os.put((value >> (8 * i)) & 0xff);
+		}
+	}
+
+	void string(const std::string& value) {
+		u32(value.size());
+		os.write(value.data(), value.size());
+	}
+
+	void type(const Type* type) {
+		switch (type->getCategory()) {
+		case PRIMITIVE:
+			u8(TAG_PRIMITIVE);
+			u8(static_cast<const PrimitiveType*>(type)->getPrimitive());
+			break;
+		case REFERENCE:
+			u8(TAG_REFERENCE);
+			break;
+		case ARRAY: {
+			const ArrayType* at = static_cast<const ArrayType*>(type);
+			u8(TAG_ARRAY);
+			this->type(at->getElementType());
+			u32(at->getDimension());
+			u32(at->getStaticSize());
+			break;
+		}
+		case CLASS:
+			u8(TAG_CLASS);
+			string(static_cast<const ClassType*>(type)->getName());
+			break;
+		}
+	}
+};
+
+class InterfaceReader {
+private:
+	const unsigned char* data;
+	size_t size;
+	size_t pos;
+
+	const unsigned char* next(size_t n) {
+		if (n > size - pos) {
+			ImportError err;
+			err.getStream() << "Unexpected end of interface file";
+			throw err;
+		}
+		const unsigned char* p = data + pos;
+		pos += n;
+		return p;
+	}
+public:
+	InterfaceReader(const char* data, size_t size) :
+			data((const unsigned char*) data), size(size), pos(0) {
+	}
+
+	unsigned char u8() {
+		return *next(1);
+	}
+
+	uint32_t u32() {
+		const unsigned char* p = next(4);
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+	}
+
+	std::string string() {
+		uint32_t length = u32();
+		return std::string((const char*) next(length), length);
+	}
+
+	const Type* type(const TypeInfo& typeInfo) {
+		switch (u8()) {
+		case TAG_PRIMITIVE:
+			switch ((signed char) u8()) {
+			case INT8:
+				return &PrimitiveType::INT8_TYPE;
+			case INT32:
+				return &PrimitiveType::INT32_TYPE;
+			case FLOAT64:
+				return &PrimitiveType::FLOAT64_TYPE;
+			case BOOLEAN:
+				return &PrimitiveType::BOOLEAN_TYPE;
+			case VOID:
+				return &PrimitiveType::VOID_TYPE;
+			case NIL:
+				return &PrimitiveType::NULL_TYPE;
+			}
+			break;
+		case TAG_REFERENCE:
+			return &ReferenceType::REFERENCE_TYPE;
+		case TAG_ARRAY: {
+			const Type* elementType = type(typeInfo);
+			int dimension = u32();
+			int staticSize = u32();
+			return TypeContext::getArray(elementType, dimension, staticSize);
+		}
+		case TAG_CLASS:
+			return typeInfo.getType(string(), 0);
+		}
+		ImportError err;
+		err.getStream() << "Invalid type in interface file";
+		throw err;
+	}
+};
+
+std::string juli::InterfaceFile::getFilename(const std::string& module) {
+	return module + ".jli";
+}
+
+void juli::InterfaceFile::write(const std::string& filename, const NBlock* ast, const TypeInfo& typeInfo) {
+	std::vector<const NImportStatement*> imports;
+	std::vector<const ClassType*> classes;
+	std::vector<const NFunctionDefinition*> functions;
+	for (StatementList::const_iterator i = ast->statements.begin(); i != ast->statements.end(); ++i) {
+		switch ((*i)->getType()) {
+		case IMPORT:
+			imports.push_back(static_cast<const NImportStatement*>(*i));
+			break;
+		case CLASS_DEF:
+			classes.push_back(static_cast<const ClassType*>(typeInfo.getType(
+					static_cast<const NClassDefinition*>(*i)->name->name, *i)));
+			break;
+		case FUNCTION_DEF:
+			functions.push_back(static_cast<const NFunctionDefinition*>(*i));
+			break;
+		default:
+			break;
+		}
+	}
+
+	// write to a temporary file first, so concurrent importers never see a partial interface:
+	std::string tmpFilename = filename + ".tmp";
+	std::ofstream os(tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	InterfaceWriter w(os);
+	os.write(MAGIC, sizeof(MAGIC));
+	w.u32(VERSION);
+
+	w.u32(imports.size());
+	for (std::vector<const NImportStatement*>::iterator i = imports.begin(); i != imports.end(); ++i) {
+		w.string((*i)->name->name);
+	}
+
+	// all class names first, fields may refer to any of them:
+	w.u32(classes.size());
+	for (std::vector<const ClassType*>::iterator i = classes.begin(); i != classes.end(); ++i) {
+		w.string((*i)->getName());
+	}
+	for (std::vector<const ClassType*>::iterator i = classes.begin(); i != classes.end(); ++i) {
+		std::vector<Field> fields = (*i)->getFields();
+		w.u32(fields.size());
+		for (std::vector<Field>::iterator f = fields.begin(); f != fields.end(); ++f) {
+			w.string(f->name);
+			w.u32(f->index);
+			w.type(f->type);
+		}
+	}
+
+	w.u32(functions.size());
+	for (std::vector<const NFunctionDefinition*>::iterator i = functions.begin(); i != functions.end(); ++i) {
+		const NFunctionSignature* signature = (*i)->signature;
+		w.string(signature->name);
+		w.type(signature->type->resolve(typeInfo));
+		w.u8(signature->varArgs);
+		w.u32(signature->modifiers);
+		w.u32(signature->arguments.size());
+		for (VariableList::const_iterator a = signature->arguments.begin(); a != signature->arguments.end(); ++a) {
+			w.string((*a)->name->name);
+			w.type((*a)->type->resolve(typeInfo));
+		}
+	}
+
+	os.close();
+	if (!os || rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+		remove(tmpFilename.c_str());
+		Error err;
+		err.getStream() << "Could not write interface file " << filename;
+		throw err;
+	}
+}
+
+juli::InterfaceImportLoader::InterfaceImportLoader(Importer& parent) :
+		parent(parent) {
+}
+
+TypeInfo* juli::InterfaceImportLoader::read(const char* data, size_t size) {
+	InterfaceReader r(data, size);
+	for (unsigned int i = 0; i < sizeof(InterfaceFile::MAGIC); ++i) {
+		if (r.u8() != (unsigned char) InterfaceFile::MAGIC[i])
+			return 0;
+	}
+	if (r.u32() != InterfaceFile::VERSION)
+		return 0;
+
+	TypeInfo* typeInfo = new TypeInfo();
+	try {
+		unsigned int importCount = r.u32();
+		for (unsigned int i = 0; i < importCount; ++i) {
+			typeInfo->addParent(parent.getTypes(r.string()));
+		}
+
+		std::vector<ClassType*> classes(r.u32());
+		for (std::vector<ClassType*>::iterator i = classes.begin(); i != classes.end(); ++i) {
+			*i = new ClassType(r.string(), std::vector<Field>());
+			typeInfo->declareClass(*i);
+		}
+		for (std::vector<ClassType*>::iterator i = classes.begin(); i != classes.end(); ++i) {
+			std::vector<Field> fields(r.u32());
+			for (std::vector<Field>::iterator f = fields.begin(); f != fields.end(); ++f) {
+				f->name = r.string();
+				f->index = r.u32();
+				f->type = r.type(*typeInfo);
+			}
+			(*i)->addFields(fields);
+		}
+
+		unsigned int functionCount = r.u32();
+		for (unsigned int i = 0; i < functionCount; ++i) {
+			std::string name = r.string();
+			const Type* resultType = r.type(*typeInfo);
+			bool varArgs = r.u8();
+			unsigned int modifiers = r.u32();
+			std::vector<FormalParameter> arguments;
+			unsigned int argumentCount = r.u32();
+			for (unsigned int a = 0; a < argumentCount; ++a) {
+				std::string argumentName = r.string();
+				arguments.push_back(FormalParameter(r.type(*typeInfo), argumentName));
+			}
+			typeInfo->declareFunction(Function::get(name, resultType, arguments, varArgs, modifiers));
+		}
+	} catch (ImportError& e) {
+		// imports of this module failed or the file is broken, let the next loader try
+		delete typeInfo;
+		return 0;
+	} catch (CompilerError& e) {
+		delete typeInfo;
+		return 0;
+	}
+	return typeInfo;
+}
+
+TypeInfo* juli::InterfaceImportLoader::importTypes(const std::string& module) {
+	std::string filename = InterfaceFile::getFilename(module);
+	time_t interfaceTime = getModificationTime(filename);
+	time_t sourceTime = getModificationTime(SourceImportLoader::getSourceFile(module));
+	// equal times are ambiguous, the source may have been saved right after the interface was written:
+	if (interfaceTime == 0 || (sourceTime != 0 && interfaceTime <= sourceTime))
+		return 0;
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return 0;
+	}
+	void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return 0;
+
+	TypeInfo* typeInfo;
+	try {
+		typeInfo = read((const char*) data, st.st_size);
+	} catch (ImportError& e) {
+		typeInfo = 0;
+	}
+	munmap(data, st.st_size);
+
+	if (typeInfo)
+		stamps[module] = std::make_pair(FileStamp::of(filename),
+				FileStamp::of(SourceImportLoader::getSourceFile(module)));
+	return typeInfo;
+}
+
+bool juli::InterfaceImportLoader::isUpToDate(const std::string& module) const {
+	std::map<std::string, std::pair<FileStamp, FileStamp> >::const_iterator i = stamps.find(module);
+	return i != stamps.end() && i->second.first == FileStamp::of(InterfaceFile::getFilename(module))
+			&& i->second.second == FileStamp::of(SourceImportLoader::getSourceFile(module));
+}
+
+std::string juli::InterfaceImportLoader::getFilename(const std::string& module) const {
+	return InterfaceFile::getFilename(module);
+}
@@ -0,0 +1,62 @@
+/*
+ * interface.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INTERFACE_H_
+#define INTERFACE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <builder/builder.h>
+
+namespace juli {
+
+/*
+ * Compiled module interfaces (.jli): the imports, classes (with their fields) and function signatures
+ * a module defines, so importing it needs neither parsing nor declaring its source.
+ *
+ * All integers are stored little endian, strings as u32 length + bytes, types as a u8 tag followed by
+ * the primitive (i8), the class name or element type, dimension (u32) and static size (i32) of an array.
+ */
+class InterfaceFile {
+public:
+	static const char MAGIC[4];
+	static const unsigned int VERSION;
+
+	static std::string getFilename(const std::string& module);
+
+	/*
+	 * Writes the interface of the module ast, whose types must already be resolved in typeInfo.
+	 */
+	static void write(const std::string& filename, const NBlock* ast, const TypeInfo& typeInfo);
+};
+
+/*
+ * Imports a module from its interface file, if that is newer than the source of the module. The file
+ * is memory mapped, anything unexpected in it makes the loader fall back to the next one.
+ */
+class InterfaceImportLoader: public ImportLoader {
+private:
+	Importer& parent;
+
+	// the stamps of the interface and the source each module was imported with:
+	std::map<std::string, std::pair<FileStamp, FileStamp> > stamps;
+
+	TypeInfo* read(const char* data, size_t size);
+public:
+	InterfaceImportLoader(Importer& parent);
+
+	virtual TypeInfo* importTypes(const std::string& module);
+
+	virtual bool isUpToDate(const std::string& module) const;
+
+	virtual std::string getFilename(const std::string& module) const;
+};
+
+}
+
+#endif /* INTERFACE_H_ */
@@ -0,0 +1,236 @@
+#include "server.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace juli;
+
+static std::string socketError(const std::string& what) {
+	std::stringstream s;
+	s << what << ": " << strerror(errno);
+	return s.str();
+}
+
+static sockaddr_un getAddress(const std::string& socketPath) {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		Error err;
+		err.getStream() << "Socket path too long: " << socketPath;
+		throw err;
+	}
+	strcpy(address.sun_path, socketPath.c_str());
+	return address;
+}
+
+static std::string readAll(int fd) {
+	std::string data;
+	char buffer[4096];
+	ssize_t n;
+	while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			Error err;
+			err.getStream() << socketError("Could not read from socket");
+			throw err;
+		}
+		data.append(buffer, n);
+	}
+	return data;
+}
+
+static void writeAll(int fd, const std::string& data) {
+	const char* p = data.c_str();
+	size_t remaining = data.size();
+	while (remaining > 0) {
+		ssize_t n = send(fd, p, remaining, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			Error err;
+			err.getStream() << socketError("Could not write to socket");
+			throw err;
+		}
+		p += n;
+		remaining -= n;
+	}
+}
+
+static std::map<std::string, std::string> parseRequest(const std::string& request) {
+	std::map<std::string, std::string> values;
+	std::stringstream s(request);
+	std::string line;
+	while (std::getline(s, line)) {
+		size_t split = line.find('=');
+		if (split != std::string::npos)
+			values[line.substr(0, split)] = line.substr(split + 1);
+	}
+	return values;
+}
+
+juli::CompileServer::CompileServer(Compiler& compiler, const std::string& socketPath,
+		const std::string& configuration) :
+		compiler(compiler), socketPath(socketPath), configuration(configuration) {
+}
+
+std::string juli::CompileServer::getDefaultSocket() {
+	std::stringstream s;
+	s << "/tmp/jlc-" << getuid() << ".sock";
+	return s.str();
+}
+
+bool juli::CompileServer::handle(int connection) {
+	std::map<std::string, std::string> request = parseRequest(readAll(connection));
+	if (request["shutdown"] == "1") {
+		writeAll(connection, "0\n");
+		return false;
+	}
+
+	std::stringstream diagnostics;
+	int status;
+	if (request["configuration"] != configuration) {
+		diagnostics << "The compile server runs with '" << configuration << "', but '" << request["configuration"]
+				<< "' was requested" << std::endl;
+		status = 2;
+	} else if (chdir(request["cwd"].c_str()) != 0) {
+		diagnostics << socketError("Could not change to " + request["cwd"]) << std::endl;
+		status = 2;
+	} else {
+		try {
+			// imports are resolved relative to the working directory, and their sources may have changed:
+			if (request["cwd"] != cwd) {
+				compiler.getImporter().clear();
+				cwd = request["cwd"];
+			} else {
+				compiler.getImporter().refresh();
+			}
+
+			CompileJob job;
+			job.inputFilename = request["input"];
+			job.outputFilename = request["output"];
+			job.outputIRFilename = request["irtext"];
+			job.outputASTFilename = request["ast"];
+			job.outputInterfaceFilename = request["interface"];
+			status = compiler.compile(job, diagnostics);
+		} catch (std::exception& e) {
+			// e.g. out of memory, fails this request but not the server:
+			diagnostics << "Internal compiler error: " << e.what() << std::endl;
+			status = 2;
+		}
+	}
+
+	std::stringstream response;
+	response << status << std::endl << diagnostics.str();
+	writeAll(connection, response.str());
+	return true;
+}
+
+void juli::CompileServer::run() {
+	sockaddr_un address = getAddress(socketPath);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		Error err;
+		err.getStream() << socketError("Could not create socket");
+		throw err;
+	}
+
+	unlink(socketPath.c_str());
+	if (bind(listener, (sockaddr*) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+		Error err;
+		err.getStream() << socketError("Could not listen on " + socketPath);
+		close(listener);
+		throw err;
+	}
+
+	// the server writes files with our permissions, so only we may talk to it:
+	chmod(socketPath.c_str(), S_IRUSR | S_IWUSR);
+
+	bool running = true;
+	while (running) {
+		int connection = accept(listener, 0, 0);
+		if (connection < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		ucred peer;
+		socklen_t length = sizeof(peer);
+		if (getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &peer, &length) != 0 || peer.uid != getuid()) {
+			close(connection);
+			continue;
+		}
+		try {
+			running = handle(connection);
+		} catch (Error& e) {
+			// a client that went away must not take the server down
+		} catch (std::exception& e) {
+		}
+		close(connection);
+	}
+
+	close(listener);
+	unlink(socketPath.c_str());
+}
+
+static std::string sendRequest(const std::string& socketPath, const std::string& request) {
+	sockaddr_un address = getAddress(socketPath);
+
+	int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0 || connect(connection, (sockaddr*) &address, sizeof(address)) != 0) {
+		Error err;
+		err.getStream() << socketError("Could not connect to compile server " + socketPath);
+		if (connection >= 0)
+			close(connection);
+		throw err;
+	}
+
+	std::string response;
+	try {
+		writeAll(connection, request);
+		shutdown(connection, SHUT_WR);
+		response = readAll(connection);
+	} catch (Error& e) {
+		close(connection);
+		throw;
+	}
+	close(connection);
+	return response;
+}
+
+int juli::compileRemote(const std::string& socketPath, const std::string& configuration, const CompileJob& job,
+		std::ostream& diagnostics) {
+	char* cwd = getcwd(0, 0);
+	std::stringstream request;
+	request << "cwd=" << cwd << std::endl;
+	request << "configuration=" << configuration << std::endl;
+	request << "input=" << job.inputFilename << std::endl;
+	request << "output=" << job.outputFilename << std::endl;
+	request << "irtext=" << job.outputIRFilename << std::endl;
+	request << "ast=" << job.outputASTFilename << std::endl;
+	request << "interface=" << job.outputInterfaceFilename << std::endl;
+	free(cwd);
+
+	std::string response = sendRequest(socketPath, request.str());
+	size_t eol = response.find('\n');
+	if (eol == std::string::npos) {
+		diagnostics << "Invalid response from compile server" << std::endl;
+		return 2;
+	}
+	diagnostics << response.substr(eol + 1);
+	return atoi(response.substr(0, eol).c_str());
+}
+
+void juli::stopServer(const std::string& socketPath) {
+	sendRequest(socketPath, "shutdown=1\n");
+}
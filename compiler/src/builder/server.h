@@ -0,0 +1,63 @@
+/*
+ * server.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <map>
+#include <string>
+#include <ostream>
+
+#include <builder/compiler.h>
+
+namespace juli {
+
+/*
+ * Serves compile requests on a Unix socket, one connection per request. The compiler (and with it the
+ * target machine and the imported modules) stays alive between requests.
+ *
+ * A request is a list of "key=value" lines, terminated by closing the sending side of the connection:
+ *
+ * cwd=<working directory>, configuration=<compiler options, must match the server's>, input=<file>,
+ * output=<file>, irtext=<file>, ast=<file>, interface=<file>, or shutdown=1 to stop the server.
+ *
+ * The response is the exit status on the first line, followed by the diagnostics.
+ *
+ * Imported modules are cached by name, so the cache is dropped when a request comes from another working
+ * directory than the previous one.
+ */
+class CompileServer {
+private:
+	Compiler& compiler;
+	const std::string socketPath;
+	const std::string configuration;
+
+	// the working directory of the last request, the imported modules were resolved relative to it:
+	std::string cwd;
+
+	bool handle(int connection);
+public:
+	CompileServer(Compiler& compiler, const std::string& socketPath, const std::string& configuration);
+
+	static std::string getDefaultSocket();
+
+	/*
+	 * Serves requests until a shutdown request arrives.
+	 */
+	void run();
+};
+
+/*
+ * Sends a compile request to a running server, returns the exit status of the compilation.
+ */
+int compileRemote(const std::string& socketPath, const std::string& configuration, const CompileJob& job,
+		std::ostream& diagnostics);
+
+void stopServer(const std::string& socketPath);
+
+}
+
+#endif /* SERVER_H_ */
@@ -2,18 +2,23 @@
 
 #include <parser/ast/visitor.h>
 #include <analysis/type/functions.h>
+#include <profile/profiler.h>
 
 #include <llvm/Analysis/Verifier.h>
+#include <llvm/Attributes.h>
 #include <llvm/DerivedTypes.h>
 #include <llvm/IRBuilder.h>
+#include <llvm/Intrinsics.h>
 #include <llvm/LLVMContext.h>
 #include <llvm/Module.h>
 #include <llvm/Value.h>
+#include <llvm/Transforms/Scalar.h>
 
 using namespace juli;
 
 const int juli::IRGenerator::ARRAY_FIELD_PTR = 0;
 const int juli::IRGenerator::ARRAY_FIELD_LENGTH = 1;
+const int juli::IRGenerator::ARRAY_FIELD_STRIDES = 2;
 
 llvm::Value* juli::IRGenerator::fieldPtr(llvm::Value* objAddr, int index) {
 	std::vector<llvm::Value*> indices;
@@ -22,20 +27,280 @@ llvm::Value* juli::IRGenerator::fieldPtr(llvm::Value* objAddr, int index) {
 	return builder.CreateGEP(objAddr, indices);
 }
 
-llvm::Value* juli::IRGenerator::fieldGet(llvm::Value* objAddr, int index) {
-	return builder.CreateLoad(fieldPtr(objAddr, index));
+llvm::Value* juli::IRGenerator::fieldGet(llvm::Value* objAddr, int index, llvm::MDNode* tbaa) {
+	return setAliasTag(builder.CreateLoad(fieldPtr(objAddr, index)), tbaa);
 }
 
-void juli::IRGenerator::fieldSet(llvm::Value* objAddr, int index, llvm::Value* value) {
-	builder.CreateStore(value, fieldPtr(objAddr, index));
+void juli::IRGenerator::fieldSet(llvm::Value* objAddr, int index, llvm::Value* value, llvm::MDNode* tbaa) {
+	setAliasTag(builder.CreateStore(value, fieldPtr(objAddr, index)), tbaa);
 }
 
-llvm::Value* juli::IRGenerator::staticArrayIndex(llvm::Value* arrAddr, int index) {
+llvm::Value* juli::IRGenerator::staticArrayIndex(llvm::Value* arrAddr, int index, llvm::MDNode* tbaa) {
 	std::vector<llvm::Value*> indices;
 	indices.push_back(zero_i32);
 	indices.push_back(llvm::ConstantInt::get(context, llvm::APInt(32, index, true)));
 	llvm::Value* ptr = builder.CreateGEP(arrAddr, indices);
-	return builder.CreateLoad(ptr);
+	return setAliasTag(builder.CreateLoad(ptr), tbaa);
+}
+
+llvm::Instruction* juli::IRGenerator::setAliasTag(llvm::Instruction* access, llvm::MDNode* tbaa) {
+	if (tbaa)
+		access->setMetadata(llvm::LLVMContext::MD_tbaa, tbaa);
+	return access;
+}
+
+llvm::MDNode* juli::IRGenerator::getAliasTag(const NExpression* e) {
+	switch (e->getType()) {
+	case VARIABLE_REF:
+		return aliasInfo.getTypeNode(e->expressionType);
+	case QUALIFIED_ACCESS: {
+		const NQualifiedAccess* qa = static_cast<const NQualifiedAccess*>(e);
+		const Type* refType = qa->ref->expressionType;
+		if (refType->getCategory() == CLASS) {
+			const ClassType* ct = static_cast<const ClassType*>(refType);
+			return aliasInfo.getFieldNode(ct, ct->getField(qa->name->name));
+		} else if (refType->getCategory() == ARRAY) {
+			return aliasInfo.getHeaderNode(static_cast<const ArrayType*>(refType), TypeAliasInfo::HEADER_LENGTH);
+		}
+		return 0;
+	}
+	case ARRAY_ACCESS: {
+		const NArrayAccess* aa = static_cast<const NArrayAccess*>(e);
+		const ArrayType* at = static_cast<const ArrayType*>(aa->ref->expressionType);
+		if (at->getStaticSize() >= 0) {
+			return getAliasTag(aa->ref); // m.length[i] reads the header of m
+		}
+		return aliasInfo.getElementNode(at);
+	}
+	default:
+		return 0;
+	}
+}
+
+llvm::AllocaInst* juli::IRGenerator::createEntryBlockAlloca(llvm::Type* type, const std::string& name) {
+	// all stack slots go to the top of the entry block, so mem2reg can promote them:
+	llvm::BasicBlock& entry = builder.GetInsertBlock()->getParent()->getEntryBlock();
+	llvm::IRBuilder<> entryBuilder(&entry, entry.begin());
+	return entryBuilder.CreateAlloca(type, 0, name);
+}
+
+void juli::IRGenerator::setVariable(int slot, llvm::Value* address) {
+	if (slot >= (int) variables.size())
+		variables.resize(slot + 1);
+	variables[slot] = address;
+}
+
+bool juli::IRGenerator::isString(const Type* type) {
+	if (type->getCategory() != ARRAY)
+		return false;
+	const ArrayType* at = static_cast<const ArrayType*>(type);
+	return at == TypeContext::getArray(&PrimitiveType::INT8_TYPE);
+}
+
+llvm::Value* juli::IRGenerator::createStringHeader(llvm::Value* data, llvm::Value* length) {
+	const ArrayType* stringType = TypeContext::getArray(&PrimitiveType::INT8_TYPE);
+
+	if (translationUnit.getArrayLayout() == ARRAY_LAYOUT_INLINE) {
+		// the characters have to live right behind the header:
+		std::vector<llvm::Value*> sizes;
+		sizes.push_back(length);
+		llvm::Value* result = allocateArray(stringType, sizes);
+		builder.CreateMemCpy(arrayData(result, stringType), data, length, 1);
+		return result;
+	}
+
+	return builder.CreateCall2(getStringConstructor(), data, length);
+}
+
+llvm::Function* juli::IRGenerator::createConstructor(const std::string& name, llvm::Type* resultType,
+		const std::vector<llvm::Type*>& params) {
+	llvm::Function* f = llvm::Function::Create(llvm::FunctionType::get(resultType, params, false),
+			llvm::Function::InternalLinkage, name, &module);
+	// header loads are tagged as constant memory, so the stores initializing a header must never
+	// end up in the same function (and basic block) as the loads reading it:
+	f->addFnAttr(llvm::Attribute::NoInline);
+	builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", f));
+	return f;
+}
+
+llvm::Function* juli::IRGenerator::getStringConstructor() {
+	const std::string name = "juli.string";
+	llvm::Function* f = module.getFunction(name);
+	if (f)
+		return f;
+
+	const ArrayType* stringType = TypeContext::getArray(&PrimitiveType::INT8_TYPE);
+	std::vector<llvm::Type*> params;
+	params.push_back(llvm::Type::getInt8PtrTy(context));
+	params.push_back(llvm::Type::getInt32Ty(context));
+
+	llvm::IRBuilderBase::InsertPoint ip = builder.saveIP();
+	f = createConstructor(name, resolveType(stringType), params);
+	llvm::Function::arg_iterator arg = f->arg_begin();
+	llvm::Value* data = arg++;
+	llvm::Value* length = arg++;
+
+	llvm::Value* pi8 = builder.CreateCall(module.getFunction("malloc"), getConstantInt32(getSizeOf(stringType)));
+	llvm::Value* result = builder.CreateBitCast(pi8, resolveType(stringType));
+	fieldSet(result, ARRAY_FIELD_PTR, data);
+	fieldSet(result, ARRAY_FIELD_LENGTH, length);
+	builder.CreateRet(result);
+
+	builder.restoreIP(ip);
+	return f;
+}
+
+llvm::Value* juli::IRGenerator::toCString(const NExpression* e, llvm::Value* v) {
+	const NCast* c = dynamic_cast<const NCast*>(e);
+	if (c && c->expression->getType() == NULL_LITERAL) {
+		return llvm::ConstantPointerNull::get(llvm::Type::getInt8PtrTy(context));
+	}
+
+	// the header of a null char[] must not be read:
+	llvm::Function* f = builder.GetInsertBlock()->getParent();
+	llvm::BasicBlock* nullBlock = builder.GetInsertBlock();
+	llvm::BasicBlock* dataBlock = llvm::BasicBlock::Create(context, "cstr_data", f);
+	llvm::BasicBlock* contBlock = llvm::BasicBlock::Create(context, "cstr_continue", f);
+	builder.CreateCondBr(builder.CreateIsNull(v), contBlock, dataBlock);
+
+	builder.SetInsertPoint(dataBlock);
+	llvm::Value* data = arrayData(v, static_cast<const ArrayType*>(e->expressionType));
+	dataBlock = builder.GetInsertBlock();
+	builder.CreateBr(contBlock);
+
+	builder.SetInsertPoint(contBlock);
+	llvm::PHINode* result = builder.CreatePHI(data->getType(), 2, "cstr");
+	result->addIncoming(llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(data->getType())), nullBlock);
+	result->addIncoming(data, dataBlock);
+	return result;
+}
+
+llvm::Value* juli::IRGenerator::fromCString(llvm::Value* cstr) {
+	llvm::Function* f = builder.GetInsertBlock()->getParent();
+	llvm::BasicBlock* nullBlock = builder.GetInsertBlock();
+	llvm::BasicBlock* wrapBlock = llvm::BasicBlock::Create(context, "cstr_wrap", f);
+	llvm::BasicBlock* contBlock = llvm::BasicBlock::Create(context, "cstr_wrap_continue", f);
+	builder.CreateCondBr(builder.CreateIsNull(cstr), contBlock, wrapBlock);
+
+	builder.SetInsertPoint(wrapBlock);
+	llvm::Value* header = createStringHeader(cstr, builder.CreateCall(module.getFunction("strlen"), cstr));
+	wrapBlock = builder.GetInsertBlock();
+	builder.CreateBr(contBlock);
+
+	builder.SetInsertPoint(contBlock);
+	llvm::PHINode* result = builder.CreatePHI(header->getType(), 2, "string");
+	result->addIncoming(llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(header->getType())), nullBlock);
+	result->addIncoming(header, wrapBlock);
+	return result;
+}
+
+llvm::Value* juli::IRGenerator::alignedAlloc(llvm::Value* size) {
+	llvm::Type* sizeType = llvm::IntegerType::get(context, getPointerSize() * 8);
+	llvm::Type* pi8Type = llvm::Type::getInt8PtrTy(context);
+	llvm::Constant* posixMemalign = module.getOrInsertFunction("posix_memalign", llvm::Type::getInt32Ty(context),
+			llvm::PointerType::get(pi8Type, 0), sizeType, sizeType, NULL);
+
+	llvm::Value* memory = createEntryBlockAlloca(pi8Type);
+	llvm::Value* error = builder.CreateCall3(posixMemalign, memory,
+			llvm::ConstantInt::get(sizeType, TranslationUnit::ARRAY_ALIGNMENT), builder.CreateZExtOrBitCast(size, sizeType));
+	// the pointer is undefined if the allocation failed, which then yields null like malloc:
+	return builder.CreateSelect(builder.CreateICmpEQ(error, zero_i32), builder.CreateLoad(memory),
+			llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(pi8Type)));
+}
+
+llvm::Value* juli::IRGenerator::arrayData(llvm::Value* arrAddr, const ArrayType* at) {
+	if (translationUnit.getArrayLayout() == ARRAY_LAYOUT_INLINE) {
+		// no need to load the data pointer, the elements start right behind the header:
+		llvm::StructType* header = llvm::cast<llvm::StructType>(arrAddr->getType()->getPointerElementType());
+		return builder.CreateBitCast(builder.CreateGEP(arrAddr, one_i32), header->getElementType(ARRAY_FIELD_PTR));
+	}
+	return fieldGet(arrAddr, ARRAY_FIELD_PTR, aliasInfo.getHeaderNode(at, TypeAliasInfo::HEADER_DATA));
+}
+
+llvm::Value* juli::IRGenerator::allocateArray(const ArrayType* at, const std::vector<llvm::Value*>& sizes) {
+	return builder.CreateCall(getArrayConstructor(at), sizes);
+}
+
+llvm::Function* juli::IRGenerator::getArrayConstructor(const ArrayType* at) {
+	const std::string name = "juli.new." + at->mangle();
+	llvm::Function* f = module.getFunction(name);
+	if (f)
+		return f;
+
+	std::vector<llvm::Type*> params(at->getDimension(), llvm::Type::getInt32Ty(context));
+
+	llvm::IRBuilderBase::InsertPoint ip = builder.saveIP();
+	f = createConstructor(name, resolveType(at), params);
+	std::vector<llvm::Value*> sizes;
+	for (llvm::Function::arg_iterator arg = f->arg_begin(); arg != f->arg_end(); ++arg) {
+		sizes.push_back(arg);
+	}
+	builder.CreateRet(initArray(at, sizes));
+	ssaPasses.run(*f);
+
+	builder.restoreIP(ip);
+	return f;
+}
+
+llvm::Value* juli::IRGenerator::initArray(const ArrayType* at, const std::vector<llvm::Value*>& sizes) {
+	const Type* etype = at->getElementType();
+	llvm::Type* elementType = resolveType(etype);
+	llvm::Value* headerSize = getConstantInt32(getSizeOf(at));
+
+	llvm::Value* memorySize = getConstantInt32(getSizeOf(etype, false));
+	for (std::vector<llvm::Value*>::const_iterator s = sizes.begin(); s != sizes.end(); ++s) {
+		memorySize = builder.CreateMul(*s, memorySize);
+	}
+
+	// char[] data stays NUL-terminated so it can be passed to C functions:
+	if (isString(at))
+		memorySize = builder.CreateAdd(memorySize, one_i32);
+
+	llvm::Value* result;
+	llvm::Value* pi8;
+	if (translationUnit.getArrayLayout() == ARRAY_LAYOUT_INLINE) {
+		// one allocation: [header | padding | data], the data is cache line aligned
+		llvm::Value* memory = alignedAlloc(builder.CreateAdd(headerSize, memorySize));
+		result = builder.CreateBitCast(memory, resolveType(at));
+		pi8 = builder.CreateGEP(memory, headerSize);
+	} else {
+		llvm::Function* malloc = module.getFunction("malloc");
+		result = builder.CreateBitCast(builder.CreateCall(malloc, headerSize), resolveType(at));
+		pi8 = builder.CreateCall(malloc, memorySize);
+	}
+
+	if (isString(at))
+		builder.CreateStore(zero_i8, builder.CreateGEP(pi8, sizes.back()));
+
+	llvm::Value* ptr = builder.CreateBitCast(pi8, llvm::PointerType::get(elementType, 0));
+	fieldSet(result, ARRAY_FIELD_PTR, ptr);
+
+	int i = 0;
+	for (std::vector<llvm::Value*>::const_iterator s = sizes.begin(); s != sizes.end(); ++s) {
+		std::vector<llvm::Value*> indices;
+		indices.push_back(zero_i32);
+		indices.push_back(one_i32);
+		if (sizes.size() > 1)
+			indices.push_back(getConstantInt32(i++));
+		llvm::Value* sizePtr = builder.CreateGEP(result, indices);
+		builder.CreateStore(*s, sizePtr);
+	}
+
+	// precompute the strides once, so element accesses don't need to multiply the lengths:
+	if (sizes.size() > 1) {
+		llvm::Value* stride = one_i32;
+		for (int d = sizes.size() - 2; d >= 0; --d) {
+			stride = builder.CreateMul(sizes[d + 1], stride);
+
+			std::vector<llvm::Value*> indices;
+			indices.push_back(zero_i32);
+			indices.push_back(getConstantInt32(ARRAY_FIELD_STRIDES));
+			indices.push_back(getConstantInt32(d));
+			builder.CreateStore(stride, builder.CreateGEP(result, indices));
+		}
+	}
+
+	return result;
 }
 
 llvm::ConstantInt* juli::IRGenerator::getConstantInt32(int v) {
@@ -47,7 +312,7 @@ llvm::ConstantFP* juli::IRGenerator::getConstantDouble(double v) {
 }
 
 unsigned int juli::IRGenerator::getPointerSize() {
-	return (module.getPointerSize() == llvm::Module::Pointer64) ? 8 : 4;
+	return translationUnit.getPointerSize();
 }
 
 unsigned int juli::IRGenerator::getSizeOf(const Type* type, bool deep) {
@@ -70,12 +335,11 @@ unsigned int juli::IRGenerator::getSizeOf(const Type* type, bool deep) {
 		return 0;
 	}
 	case ARRAY: {
-		unsigned int pointerSize = getPointerSize();
-		const ArrayType* at = static_cast<const ArrayType*>(type);
-		if (*at->getElementType() == PrimitiveType::INT8_TYPE && at->getDimension() == 1) {
-			return pointerSize;
+		if (deep) {
+			return translationUnit.getArrayHeaderSize(static_cast<const ArrayType*>(type)->getDimension());
+		} else {
+			return getPointerSize();
 		}
-		return pointerSize + getSizeOf(&PrimitiveType::INT32_TYPE) * at->getDimension();
 	}
 	case CLASS: {
 		if (deep) {
@@ -95,9 +359,13 @@ unsigned int juli::IRGenerator::getSizeOf(const Type* type, bool deep) {
 
 }
 
-juli::IRGenerator::IRGenerator(const std::string& moduleName, const TypeInfo& typeInfo) :
-		typeInfo(typeInfo), translationUnit(moduleName, typeInfo), builder(translationUnit.getContext()), module(
-				*translationUnit.module), context(translationUnit.getContext()) {
+juli::IRGenerator::IRGenerator(const std::string& moduleName, const TypeInfo& typeInfo, ArrayLayout arrayLayout) :
+		typeInfo(typeInfo), translationUnit(moduleName, typeInfo, arrayLayout), builder(translationUnit.getContext()), module(
+				*translationUnit.module), context(translationUnit.getContext()), ssaPasses(translationUnit.module), aliasInfo(
+				translationUnit.getContext()) {
+	ssaPasses.add(llvm::createPromoteMemoryToRegisterPass());
+	ssaPasses.doInitialization();
+
 	zero_ui8 = llvm::ConstantInt::get(context, llvm::APInt(8, 0, bool(false)));
 	zero_ui16 = llvm::ConstantInt::get(context, llvm::APInt(16, 0, bool(false)));
 	zero_ui32 = llvm::ConstantInt::get(context, llvm::APInt(32, 0, bool(false)));
@@ -113,7 +381,7 @@ juli::IRGenerator::IRGenerator(const std::string& moduleName, const TypeInfo& ty
 
 	const Type* t_int8 = &PrimitiveType::INT8_TYPE;
 	const Type* t_int32 = &PrimitiveType::INT32_TYPE;
-	const Type* t_arr_int8 = new ArrayType(t_int8);
+	const Type* t_arr_int8 = TypeContext::getArray(t_int8);
 
 	std::vector<FormalParameter> params;
 	params.push_back(FormalParameter(t_arr_int8, "str"));
@@ -127,60 +395,84 @@ juli::IRGenerator::IRGenerator(const std::string& moduleName, const TypeInfo& ty
 void juli::IRGenerator::defineFunction(const Function* function) {
 	llvm::Function* f = getFunction(function);
 	if (function->body) {
+		std::vector<llvm::Value*> outerVariables;
+		outerVariables.swap(variables);
 
 		llvm::BasicBlock* llvmBlock = llvm::BasicBlock::Create(context, "entry", f);
 		builder.SetInsertPoint(llvmBlock);
 
 		if (function->name == "main") {
 			llvm::Function::arg_iterator i = f->getArgumentList().begin();
-
-			llvm::Type* arrTypePtr = translationUnit.resolveLLVMType(function->formalArguments[0].type);
-			llvm::Value* args = builder.CreateAlloca(arrTypePtr);
-			llvm::Value* argsValue = builder.CreateAlloca(arrTypePtr->getPointerElementType());
-			std::vector<llvm::Value*> indices;
-			indices.push_back(zero_i32);
-			indices.push_back(zero_i32);
-			llvm::Value* pPtr = builder.CreateGEP(argsValue, indices); // ptr
-			indices.pop_back();
-			indices.push_back(one_i32);
-			llvm::Value* pLength = builder.CreateGEP(argsValue, indices); // length
-			builder.CreateStore(i, pLength);
-			builder.CreateStore(++i, pPtr);
+			llvm::Value* argc = i;
+			llvm::Value* argv = ++i;
+
+			const ArrayType* argsType = static_cast<const ArrayType*>(function->formalArguments[0].type);
+			llvm::Value* args = createEntryBlockAlloca(resolveType(argsType), function->formalArguments[0].name);
+
+			// wrap the NUL-terminated C strings into length carrying char[] headers:
+			std::vector<llvm::Value*> sizes;
+			sizes.push_back(argc);
+			llvm::Value* argsValue = allocateArray(argsType, sizes);
+			llvm::Value* strings = arrayData(argsValue, argsType);
+
+			llvm::BasicBlock* condBlock = llvm::BasicBlock::Create(context, "argv_condition", f);
+			llvm::BasicBlock* bodyBlock = llvm::BasicBlock::Create(context, "argv_body", f);
+			llvm::BasicBlock* contBlock = llvm::BasicBlock::Create(context, "argv_continue", f);
+
+			builder.CreateBr(condBlock);
+			builder.SetInsertPoint(condBlock);
+			llvm::PHINode* index = builder.CreatePHI(llvm::Type::getInt32Ty(context), 2, "argv_index");
+			index->addIncoming(zero_i32, llvmBlock);
+			builder.CreateCondBr(builder.CreateICmpSLT(index, argc), bodyBlock, contBlock);
+
+			builder.SetInsertPoint(bodyBlock);
+			llvm::Value* cstr = builder.CreateLoad(builder.CreateGEP(argv, index));
+			llvm::Value* length = builder.CreateCall(module.getFunction("strlen"), cstr);
+			builder.CreateStore(createStringHeader(cstr, length), builder.CreateGEP(strings, index));
+			index->addIncoming(builder.CreateAdd(index, one_i32), bodyBlock);
+			builder.CreateBr(condBlock);
+
+			builder.SetInsertPoint(contBlock);
 			builder.CreateStore(argsValue, args);
 
-			translationUnit.addSymbol(function->formalArguments[0].name, args);
+			// the parameters are the first variables of a function:
+			setVariable(0, args);
 		} else {
 			llvm::Function::arg_iterator i = f->getArgumentList().begin();
+			int slot = 0;
 			for (std::vector<FormalParameter>::const_iterator vi = function->formalArguments.begin();
 					vi != function->formalArguments.end(); ++i, ++vi) {
-				llvm::Value* param = builder.CreateAlloca(i->getType());
+				llvm::Value* param = createEntryBlockAlloca(i->getType(), vi->name);
 				builder.CreateStore(i, param);
-				translationUnit.addSymbol(vi->name, param);
+				setVariable(slot++, param);
 			}
 		}
 
 		visit(function->body);
-
-		for (std::vector<FormalParameter>::const_iterator i = function->formalArguments.begin();
-				i != function->formalArguments.end(); ++i) {
-			translationUnit.removeSymbol(i->name);
-		}
+		variables.swap(outerVariables);
 
 		if (llvm::verifyFunction(*f, llvm::PrintMessageAction)) {
 			f->dump();
+		} else {
+			ssaPasses.run(*f);
 		}
 
 	}
 }
 
 llvm::Function* juli::IRGenerator::getFunction(const Function* function) {
-	const std::string llvmName = function->mangle();
-	std::map<std::string, llvm::Function*>::iterator i = llvmFunctionTable.find(llvmName);
-	if (i == llvmFunctionTable.end()) {
-		llvm::Function* f = createFunction(function);
-		llvmFunctionTable[llvmName] = f;
-	}
-	return llvmFunctionTable[llvmName];
+	// declarations of imported modules are shared with other compilations, only the functions of this
+	// compilation remember what they were generated to:
+	bool owned = function->isOwnedBy(FunctionPool::getCurrent());
+	if (owned && function->llvmFunction && function->llvmFunction->getParent() == &module)
+		return function->llvmFunction;
+
+	llvm::Function*& f = llvmFunctionTable[function->mangle()];
+	if (!f)
+		f = createFunction(function);
+	if (owned)
+		function->llvmFunction = f;
+	return f;
 }
 
 llvm::Type* juli::IRGenerator::resolveType(const Type* n) {
@@ -191,6 +483,12 @@ llvm::Type* juli::IRGenerator::resolveType(const NType* n) {
 	return translationUnit.resolveLLVMType(n);
 }
 
+llvm::Type* juli::IRGenerator::resolveCType(const Type* n) {
+	if (isString(n))
+		return llvm::Type::getInt8PtrTy(context);
+	return resolveType(n);
+}
+
 llvm::Value* juli::IRGenerator::visitDoubleLiteral(const NLiteral<double>* n) {
 	return llvm::ConstantFP::get(context, llvm::APFloat(n->value));
 }
@@ -200,16 +498,65 @@ llvm::Value* juli::IRGenerator::visitIntegerLiteral(const NLiteral<uint64_t>* n)
 }
 
 llvm::Value* juli::IRGenerator::visitStringLiteral(const NStringLiteral* n) {
+	// equal literals share one constant per module:
+	llvm::Constant* & literal = stringLiterals[n->value];
+	if (!literal)
+		literal = createStringLiteral(n);
+	return literal;
+}
+
+llvm::Constant* juli::IRGenerator::createStringLiteral(const NStringLiteral* n) {
 	llvm::Constant * s = llvm::ConstantDataArray::getString(context, llvm::StringRef(n->value));
-	llvm::GlobalVariable* globalStr = new llvm::GlobalVariable(module, s->getType(), true,
-			llvm::GlobalValue::PrivateLinkage, 0, ".str");
-	globalStr->setInitializer(s);
+
+	// constant char[] header pointing to the NUL-terminated data:
+	llvm::StructType* headerType = llvm::cast<llvm::StructType>(
+			resolveType(n->expressionType)->getPointerElementType());
 
 	std::vector<llvm::Constant*> indices;
 	llvm::ConstantInt* const_int64_8 = llvm::ConstantInt::get(context, llvm::APInt(64, llvm::StringRef("0"), 10));
 	indices.push_back(const_int64_8);
+
+	llvm::GlobalVariable* globalStr;
+	if (translationUnit.getArrayLayout() == ARRAY_LAYOUT_INLINE) {
+		// header and characters in one aligned global, like a heap allocated char[]:
+		std::vector<llvm::Type*> literalFields;
+		literalFields.push_back(headerType);
+		literalFields.push_back(s->getType());
+		llvm::StructType* literalType = llvm::StructType::get(context, literalFields);
+
+		globalStr = new llvm::GlobalVariable(module, literalType, true, llvm::GlobalValue::PrivateLinkage, 0, ".str");
+		globalStr->setAlignment(TranslationUnit::ARRAY_ALIGNMENT);
+		globalStr->setUnnamedAddr(true);
+		indices.push_back(llvm::ConstantInt::get(context, llvm::APInt(32, 1)));
+	} else {
+		// unnamed_addr lets the characters go to a mergeable section, so the linker can pool them:
+		globalStr = new llvm::GlobalVariable(module, s->getType(), true, llvm::GlobalValue::PrivateLinkage, 0, ".str");
+		globalStr->setUnnamedAddr(true);
+	}
 	indices.push_back(const_int64_8);
-	return llvm::ConstantExpr::getGetElementPtr(globalStr, indices);
+
+	std::vector<llvm::Constant*> fields;
+	fields.push_back(llvm::ConstantExpr::getGetElementPtr(globalStr, indices));
+	fields.push_back(getConstantInt32(n->value.size()));
+	for (unsigned int i = fields.size(); i < headerType->getNumElements(); ++i) {
+		fields.push_back(llvm::Constant::getNullValue(headerType->getElementType(i))); // padding
+	}
+	llvm::Constant* header = llvm::ConstantStruct::get(headerType, fields);
+
+	if (translationUnit.getArrayLayout() == ARRAY_LAYOUT_INLINE) {
+		std::vector<llvm::Constant*> literal;
+		literal.push_back(header);
+		literal.push_back(s);
+		globalStr->setInitializer(llvm::ConstantStruct::get(
+				llvm::cast<llvm::StructType>(globalStr->getType()->getPointerElementType()), literal));
+		return llvm::ConstantExpr::getBitCast(globalStr, llvm::PointerType::get(headerType, 0));
+	}
+
+	globalStr->setInitializer(s);
+	llvm::GlobalVariable* globalHeader = new llvm::GlobalVariable(module, headerType, true,
+			llvm::GlobalValue::PrivateLinkage, header, ".str.header");
+	globalHeader->setUnnamedAddr(true);
+	return globalHeader;
 }
 
 llvm::Value* juli::IRGenerator::visitCharLiteral(const NCharLiteral* n) {
@@ -225,14 +572,13 @@ llvm::Value* juli::IRGenerator::visitNullLiteral(const NLiteral<int>* n) {
 }
 
 llvm::Value* juli::IRGenerator::visitVariableRef(const NVariableRef* n) {
-	llvm::Value* p = translationUnit.getSymbol(n->name, n);
+	llvm::Value* p = variables[n->slot];
 	llvm::Value* result;
 
 	if (n->address)
 		result = p;
 	else
-		result = builder.CreateLoad(p);
-	;
+		result = setAliasTag(builder.CreateLoad(p), getAliasTag(n));
 
 	return result;
 }
@@ -240,15 +586,6 @@ llvm::Value* juli::IRGenerator::visitVariableRef(const NVariableRef* n) {
 llvm::Value* juli::IRGenerator::visitQualifiedAccess(NQualifiedAccess* n) {
 	llvm::Value* p = visit(n->ref);
 
-	if (p->getType() == llvm::Type::getInt8PtrTy(context) && n->name->name == "length") {
-		llvm::Function* function = module.getFunction("strlen");
-
-		std::vector<llvm::Value*> argValues;
-		argValues.push_back(p);
-
-		return builder.CreateCall(function, argValues);
-	}
-
 	if (n->ref->expressionType->getCategory() == ARRAY
 			&& static_cast<const ArrayType*>(n->ref->expressionType)->getStaticSize() >= 0) {
 		return getConstantInt32(static_cast<const ArrayType*>(n->ref->expressionType)->getStaticSize());
@@ -262,7 +599,7 @@ llvm::Value* juli::IRGenerator::visitQualifiedAccess(NQualifiedAccess* n) {
 					&& static_cast<const ArrayType*>(n->expressionType)->getStaticSize() >= 0))
 		result = f;
 	else
-		result = builder.CreateLoad(f);
+		result = setAliasTag(builder.CreateLoad(f), getAliasTag(n));
 
 	return result;
 }
@@ -354,7 +691,42 @@ llvm::Value* juli::IRGenerator::visitUnaryOperator(const NUnaryOperator* n) {
 	return 0;
 }
 
+llvm::Value* juli::IRGenerator::shortCircuit(const NBinaryOperator* n) {
+	llvm::Function* f = builder.GetInsertBlock()->getParent();
+	bool isAnd = (n->op == LAND);
+
+	llvm::Value* left = visit(n->lhs);
+	if (left == 0) // error handling
+		return 0;
+	llvm::BasicBlock* lhsBlock = builder.GetInsertBlock();
+
+	llvm::BasicBlock* rhsBlock = llvm::BasicBlock::Create(context, isAnd ? "and_rhs" : "or_rhs", f);
+	llvm::BasicBlock* contBlock = llvm::BasicBlock::Create(context, isAnd ? "and_continue" : "or_continue", f);
+
+	// the right hand side is only evaluated if it can still change the result:
+	if (isAnd)
+		builder.CreateCondBr(left, rhsBlock, contBlock);
+	else
+		builder.CreateCondBr(left, contBlock, rhsBlock);
+
+	builder.SetInsertPoint(rhsBlock);
+	llvm::Value* right = visit(n->rhs);
+	if (right == 0) // error handling
+		return 0;
+	rhsBlock = builder.GetInsertBlock(); // rhs may have opened new blocks
+	builder.CreateBr(contBlock);
+
+	builder.SetInsertPoint(contBlock);
+	llvm::PHINode* result = builder.CreatePHI(llvm::Type::getInt1Ty(context), 2, isAnd ? "and_res" : "or_res");
+	result->addIncoming(llvm::ConstantInt::get(context, llvm::APInt(1, !isAnd, true)), lhsBlock);
+	result->addIncoming(right, rhsBlock);
+	return result;
+}
+
 llvm::Value* juli::IRGenerator::visitBinaryOperator(const NBinaryOperator* n) {
+	if (n->op == LAND || n->op == LOR)
+		return shortCircuit(n);
+
 	llvm::Value* left = visit(n->lhs);
 	llvm::Value* right = visit(n->rhs);
 
@@ -440,12 +812,6 @@ llvm::Value* juli::IRGenerator::visitBinaryOperator(const NBinaryOperator* n) {
 			else if (pt->isSignedInteger())
 				return builder.CreateICmpSGE(left, right, "lt_res");
 			break;
-		case LOR:
-			return builder.CreateOr(left, right, "or_res");
-			break;
-		case LAND:
-			return builder.CreateAnd(left, right, "and_res");
-			break;
 		case UNKNOWN:
 		default:
 			std::cerr << "Unsupported binary operator " << n->op << std::endl;
@@ -466,46 +832,14 @@ llvm::Value* juli::IRGenerator::visitBinaryOperator(const NBinaryOperator* n) {
 }
 
 llvm::Value* juli::IRGenerator::visitAllocateArray(const NAllocateArray* n) {
-	llvm::Function* malloc = module.getFunction("malloc");
-
 	const ArrayType* at = dynamic_cast<const ArrayType*>(n->expressionType);
 
-	// Treat char[] differently:
-	if (*at->getElementType() == PrimitiveType::INT8_TYPE && n->sizes.size() == 1) {
-		llvm::Value* size = visit(n->sizes[0]);
-		llvm::Value* sizep1 = builder.CreateAdd(size, one_i32);
-		llvm::Value* pi8 = builder.CreateCall(malloc, sizep1);
-		llvm::Value* pi8_end = builder.CreateGEP(pi8, size);
-		builder.CreateStore(zero_i8, pi8_end);
-		return pi8;
-	}
-
-	// allocate space to store the array ref:
-	llvm::Value* pi8 = builder.CreateCall(malloc, getConstantInt32(getSizeOf(n->expressionType)));
-	llvm::Value* result = builder.CreateBitCast(pi8, resolveType(at));
-
-	// allocate the actual array memory:
-	const Type* etype = n->type->resolve(typeInfo);
-	llvm::Type* elementType = resolveType(etype);
-	llvm::Value* memorySize = getConstantInt32(getSizeOf(etype));
-	int i = 0;
+	std::vector<llvm::Value*> sizes;
 	for (std::vector<NExpression*>::const_iterator s = n->sizes.begin(); s != n->sizes.end(); ++s) {
-		llvm::Value* arraySize = visit(*s);
-		memorySize = builder.CreateMul(arraySize, memorySize);
-
-		std::vector<llvm::Value*> indices;
-		indices.push_back(zero_i32);
-		indices.push_back(one_i32);
-		if (n->sizes.size() > 1)
-			indices.push_back(getConstantInt32(i++));
-		llvm::Value* sizePtr = builder.CreateGEP(result, indices);
-		builder.CreateStore(arraySize, sizePtr);
+		sizes.push_back(visit(*s));
 	}
-	pi8 = builder.CreateCall(malloc, memorySize);
-	llvm::Value* ptr = builder.CreateBitCast(pi8, llvm::PointerType::get(elementType, 0));
-	fieldSet(result, ARRAY_FIELD_PTR, ptr);
 
-	return result;
+	return allocateArray(at, sizes);
 }
 
 llvm::Value* juli::IRGenerator::visitAllocateObject(const NAllocateObject* n) {
@@ -518,30 +852,115 @@ llvm::Value* juli::IRGenerator::visitAllocateObject(const NAllocateObject* n) {
 
 llvm::Value* juli::IRGenerator::visitFunctionCall(const NFunctionCall* n) {
 	llvm::Function* function = getFunction(n->function);
+	bool cCall = n->function->modifiers & MODIFIER_C;
 
 	std::vector<llvm::Value*> argValues;
 	for (unsigned i = 0, e = n->arguments.size(); i != e; ++i) {
 		argValues.push_back(visit(n->arguments[i]));
 		if (argValues.back() == 0)
 			return 0;
+		if (cCall && isString(n->arguments[i]->expressionType))
+			argValues.back() = toCString(n->arguments[i], argValues.back());
+	}
+
+	if (cCall) {
+		llvm::Value* intrinsic = createMathIntrinsic(n->function, argValues);
+		if (intrinsic)
+			return intrinsic;
+	}
+
+	llvm::Value* result = builder.CreateCall(function, argValues);
+	if (cCall && isString(n->function->resultType)) {
+		result = fromCString(result);
+	}
+	return result;
+}
+
+llvm::Function* juli::IRGenerator::getMathFunction(const Function* f) {
+	llvm::Function* function = getFunction(f);
+	// errno is not visible to juli programs, so the call can be folded, hoisted or dropped:
+	function->setDoesNotAccessMemory();
+	function->setDoesNotThrow();
+	return function;
+}
+
+llvm::Value* juli::IRGenerator::createMathIntrinsic(const Function* f, std::vector<llvm::Value*>& args) {
+	if (f->varArgs || !(*f->resultType == PrimitiveType::FLOAT64_TYPE))
+		return 0;
+	for (std::vector<FormalParameter>::const_iterator i = f->formalArguments.begin(); i != f->formalArguments.end();
+			++i) {
+		if (!(*i->type == PrimitiveType::FLOAT64_TYPE))
+			return 0;
+	}
+
+	llvm::Type* doubleType = llvm::Type::getDoubleTy(context);
+	const std::string& name = f->name;
+	if (name == "sqrt" && args.size() == 1) {
+		// llvm.sqrt is undefined for negative inputs, those and NaN get their result from libm:
+		llvm::Function* sqrt = llvm::Intrinsic::getDeclaration(&module, llvm::Intrinsic::sqrt, doubleType);
+		llvm::Value* nonNegative = builder.CreateFCmpOGE(args[0], zero_float);
+		return builder.CreateSelect(nonNegative, builder.CreateCall(sqrt, args[0]),
+				builder.CreateCall(getMathFunction(f), args[0]));
+	}
+	if ((name == "fmin" || name == "fmax") && args.size() == 2) {
+		// like libm, a NaN operand yields the other one (and two NaNs yield NaN):
+		llvm::Value* a = args[0];
+		llvm::Value* b = args[1];
+		llvm::Value* aFirst = (name == "fmin") ? builder.CreateFCmpOLT(a, b) : builder.CreateFCmpOGT(a, b);
+		return builder.CreateSelect(builder.CreateOr(builder.CreateFCmpUNO(b, b), aFirst), a, b);
+	}
+
+	llvm::Intrinsic::ID id;
+	unsigned int arity;
+	if (name == "fabs") {
+		id = llvm::Intrinsic::fabs;
+		arity = 1;
+	} else if (name == "floor" || name == "ceil") {
+		id = llvm::Intrinsic::floor;
+		arity = 1;
+	} else if (name == "exp") {
+		id = llvm::Intrinsic::exp;
+		arity = 1;
+	} else if (name == "log") {
+		id = llvm::Intrinsic::log;
+		arity = 1;
+	} else if (name == "pow") {
+		id = llvm::Intrinsic::pow;
+		arity = 2;
+	} else if (name == "fma") {
+		id = llvm::Intrinsic::fma;
+		arity = 3;
+	} else {
+		return 0;
 	}
+	if (args.size() != arity)
+		return 0;
 
-	return builder.CreateCall(function, argValues);
+	llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(&module, id, doubleType);
+	if (name == "ceil") {
+		// there is no ceil intrinsic, but ceil(x) == -floor(-x)
+		return builder.CreateFNeg(builder.CreateCall(intrinsic, builder.CreateFNeg(args[0])));
+	}
+	return builder.CreateCall(intrinsic, args);
 }
 
 llvm::Value* juli::IRGenerator::visitArrayAccess(const NArrayAccess* n) {
 	llvm::Value* vref = visit(n->ref);
 	llvm::Value* vindex;
 	if (n->indices.size() > 1) {
-		llvm::Value* lengthArray = fieldPtr(vref, ARRAY_FIELD_LENGTH);
-		llvm::Value* factor = one_i32;
-		int c = 0;
-		vindex = zero_i32;
+		std::vector<llvm::Value*> indexValues;
 		for (ExpressionList::const_iterator i = n->indices.begin(); i != n->indices.end(); ++i) {
-			llvm::Value * currentIndex = visit(*i);
-			llvm::Value * offsetIndex = builder.CreateMul(currentIndex, factor);
-			vindex = builder.CreateAdd(vindex, offsetIndex);
-			factor = builder.CreateMul(staticArrayIndex(lengthArray, c++), factor);
+			indexValues.push_back(visit(*i));
+		}
+
+		// row-major: index = i_0 * stride_0 + ... + i_(n-2) * stride_(n-2) + i_(n-1)
+		llvm::MDNode* strideTag = aliasInfo.getHeaderNode(static_cast<const ArrayType*>(n->ref->expressionType),
+				TypeAliasInfo::HEADER_STRIDES);
+		llvm::Value* strideArray = fieldPtr(vref, ARRAY_FIELD_STRIDES);
+		vindex = indexValues.back();
+		for (unsigned int c = 0; c < indexValues.size() - 1; ++c) {
+			llvm::Value * offsetIndex = builder.CreateMul(indexValues[c], staticArrayIndex(strideArray, c, strideTag));
+			vindex = builder.CreateAdd(offsetIndex, vindex);
 		}
 	} else {
 		vindex = visit(n->indices[0]);
@@ -551,29 +970,19 @@ llvm::Value* juli::IRGenerator::visitArrayAccess(const NArrayAccess* n) {
 	llvm::Value* result;
 	const ArrayType* at = dynamic_cast<const ArrayType*>(n->ref->expressionType);
 
-	if (*n->expressionType == PrimitiveType::INT8_TYPE && at->getDimension() == 1) {
+	if (at->getStaticSize() >= 0) {
+		std::vector<llvm::Value*> indices;
+		indices.push_back(zero_i32);
+		indices.push_back(zero_i32);
+		indices.push_back(vindex);
 		ptr = builder.CreateGEP(vref, vindex);
 	} else {
-		if (at->getStaticSize() >= 0) {
-			std::vector<llvm::Value*> indices;
-			indices.push_back(zero_i32);
-			indices.push_back(zero_i32);
-			indices.push_back(vindex);
-			ptr = builder.CreateGEP(vref, vindex);
-		} else {
-			std::vector<llvm::Value*> indices;
-			indices.push_back(zero_i32);
-			indices.push_back(zero_i32);
-
-			llvm::Value* p_dataPtr = builder.CreateGEP(vref, indices);
-			llvm::Value* dataPtr = builder.CreateLoad(p_dataPtr);
-			ptr = builder.CreateGEP(dataPtr, vindex);
-		}
+		ptr = builder.CreateGEP(arrayData(vref, at), vindex);
 	}
 	if (n->address) {
 		result = ptr;
 	} else {
-		result = builder.CreateLoad(ptr);
+		result = setAliasTag(builder.CreateLoad(ptr), getAliasTag(n));
 	}
 	return result;
 }
@@ -581,7 +990,11 @@ llvm::Value* juli::IRGenerator::visitArrayAccess(const NArrayAccess* n) {
 llvm::Value* juli::IRGenerator::visitAssignment(const NAssignment* n) {
 	llvm::Value* addr = visit(n->lhs);
 	llvm::Value* value = visit(n->rhs);
-	builder.CreateStore(value, addr);
+	llvm::MDNode* tbaa = getAliasTag(n->lhs);
+	// writing an array header (e.g. a.length = 0) must not be tagged as constant memory:
+	if (tbaa && TypeAliasInfo::isConstant(tbaa))
+		tbaa = 0;
+	setAliasTag(builder.CreateStore(value, addr), tbaa);
 	return 0;
 }
 
@@ -598,10 +1011,10 @@ llvm::Value* juli::IRGenerator::visitExpressionStatement(const NExpressionStatem
 }
 
 llvm::Value* juli::IRGenerator::visitVariableDecl(const NVariableDeclaration* n) {
-	llvm::Value* param = builder.CreateAlloca(resolveType(n->type));
+	llvm::Value* param = createEntryBlockAlloca(resolveType(n->type), n->name->name);
 	if (n->assignmentExpr)
 		builder.CreateStore(visit(n->assignmentExpr), param);
-	translationUnit.addSymbol(n->name->name, param);
+	setVariable(n->slot, param);
 	return 0;
 }
 
@@ -614,11 +1027,13 @@ llvm::FunctionType* juli::IRGenerator::createFunctionType(const Function * n) {
 		argumentTypes.push_back(llvm::PointerType::get(llvm::Type::getInt8PtrTy(context, 0), 0));
 	} else {
 
-		returnType = resolveType(n->resultType);
+		bool cFunction = n->modifiers & MODIFIER_C;
+
+		returnType = cFunction ? resolveCType(n->resultType) : resolveType(n->resultType);
 
 		for (std::vector<FormalParameter>::const_iterator i = n->formalArguments.begin(); i != n->formalArguments.end();
 				++i) {
-			argumentTypes.push_back(resolveType(i->type));
+			argumentTypes.push_back(cFunction ? resolveCType(i->type) : resolveType(i->type));
 		}
 	}
 
@@ -632,6 +1047,7 @@ llvm::Function* juli::IRGenerator::createFunction(const Function * n) {
 }
 
 llvm::Value* juli::IRGenerator::visitFunctionDef(const NFunctionDefinition* n) {
+	ProfileScope profile("irgen", n->signature->name, true);
 	defineFunction(Function::get(n, typeInfo, false));
 	return 0;
 }
@@ -708,4 +1124,5 @@ llvm::Value* juli::IRGenerator::visit(const Node* n) {
 
 void juli::IRGenerator::process(const Node* n) {
 	visit(n);
+	ssaPasses.doFinalization();
 }
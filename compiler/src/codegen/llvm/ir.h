@@ -8,13 +8,17 @@
 #ifndef IR_H_
 #define IR_H_
 
+#include <map>
 #include <string>
 
 #include <parser/ast/ast.h>
 #include <codegen/llvm/translationUnit.h>
+#include <codegen/llvm/tbaa.h>
 
 #include <utility>
 
+#include <llvm/PassManager.h>
+
 namespace juli {
 
 class IRGenerator {
@@ -25,7 +29,16 @@ private:
 	llvm::Module& module;
 	llvm::LLVMContext& context;
 
+	llvm::FunctionPassManager ssaPasses;
+
+	TypeAliasInfo aliasInfo;
+
+	std::map<std::string, llvm::Constant*> stringLiterals;
+
 	std::map<std::string, llvm::Function*> llvmFunctionTable;
+
+	// the addresses of the variables of the current function, by slot (see NameResolver):
+	std::vector<llvm::Value*> variables;
 	llvm::ConstantInt* zero_ui8;
 	llvm::ConstantInt* zero_ui16;
 	llvm::ConstantInt* zero_ui32;
@@ -40,10 +53,39 @@ private:
 
 	//helpers:
 	llvm::Value* fieldPtr(llvm::Value* objAddr, int index);
-	llvm::Value* fieldGet(llvm::Value* objAddr, int index);
-	void fieldSet(llvm::Value* objAddr, int index, llvm::Value* value);
+	llvm::Value* fieldGet(llvm::Value* objAddr, int index, llvm::MDNode* tbaa = 0);
+	void fieldSet(llvm::Value* objAddr, int index, llvm::Value* value, llvm::MDNode* tbaa = 0);
+
+	llvm::Value* staticArrayIndex(llvm::Value* arrAddr, int index, llvm::MDNode* tbaa = 0);
+
+	llvm::Instruction* setAliasTag(llvm::Instruction* access, llvm::MDNode* tbaa);
+	llvm::MDNode* getAliasTag(const NExpression* e);
 
-	llvm::Value* staticArrayIndex(llvm::Value* arrAddr, int index);
+	static bool isString(const Type* type);
+	llvm::Value* createStringHeader(llvm::Value* data, llvm::Value* length);
+	// null maps to null in both directions:
+	llvm::Value* toCString(const NExpression* e, llvm::Value* v);
+	llvm::Value* fromCString(llvm::Value* cstr);
+
+	llvm::Value* alignedAlloc(llvm::Value* size);
+	llvm::Value* arrayData(llvm::Value* arrAddr, const ArrayType* at);
+	llvm::Value* allocateArray(const ArrayType* at, const std::vector<llvm::Value*>& sizes);
+
+	llvm::Constant* createStringLiteral(const NStringLiteral* n);
+
+	// the libm declaration of a builtin math function, without side effects:
+	llvm::Function* getMathFunction(const Function* f);
+	llvm::Value* createMathIntrinsic(const Function* f, std::vector<llvm::Value*>& args);
+
+	llvm::Function* createConstructor(const std::string& name, llvm::Type* resultType,
+			const std::vector<llvm::Type*>& params);
+	llvm::Function* getArrayConstructor(const ArrayType* at);
+	llvm::Function* getStringConstructor();
+	llvm::Value* initArray(const ArrayType* at, const std::vector<llvm::Value*>& sizes);
+
+	llvm::AllocaInst* createEntryBlockAlloca(llvm::Type* type, const std::string& name = "");
+
+	void setVariable(int slot, llvm::Value* address);
 
 	llvm::ConstantInt* getConstantInt32(int v);
 	llvm::ConstantFP* getConstantDouble(double v);
@@ -53,9 +95,12 @@ private:
 
 	static const int ARRAY_FIELD_PTR;
 	static const int ARRAY_FIELD_LENGTH;
+	static const int ARRAY_FIELD_STRIDES;
 
 	void defineFunction(const Function* function);
 
+	llvm::Value* shortCircuit(const NBinaryOperator* n);
+
 public:
 
 	llvm::Function* getFunction(const Function* f);
@@ -118,8 +163,9 @@ public:
 
 	llvm::Type* resolveType(const NType* n);
 	llvm::Type* resolveType(const Type* n);
+	llvm::Type* resolveCType(const Type* n);
 
-	IRGenerator(const std::string& moduleName, const TypeInfo& typeInfo);
+	IRGenerator(const std::string& moduleName, const TypeInfo& typeInfo, ArrayLayout arrayLayout = ARRAY_LAYOUT_SPLIT);
 
 	void process(const Node* n);
 
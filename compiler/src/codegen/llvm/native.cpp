@@ -2,7 +2,8 @@
 
 using namespace juli;
 
-juli::CodeEmitter::CodeEmitter(bool allTargets) {
+juli::CodeEmitter::CodeEmitter(bool allTargets, unsigned int optLevel) :
+		optLevel(optLevel) {
 	if (allTargets) {
 		/*llvm::InitializeAllTargets();
 		llvm::InitializeAllTargetMCs();
@@ -16,7 +17,24 @@ juli::CodeEmitter::CodeEmitter(bool allTargets) {
 	}
 }
 
-llvm::TargetMachine* juli::CodeEmitter::getNativeMachine() {
+unsigned int juli::CodeEmitter::getOptLevel() const {
+	return optLevel;
+}
+
+llvm::CodeGenOpt::Level juli::CodeEmitter::getCodeGenOptLevel(unsigned int optLevel) {
+	switch (optLevel) {
+	case 0:
+		return llvm::CodeGenOpt::None;
+	case 1:
+		return llvm::CodeGenOpt::Less;
+	case 2:
+		return llvm::CodeGenOpt::Default;
+	default:
+		return llvm::CodeGenOpt::Aggressive;
+	}
+}
+
+llvm::TargetMachine* juli::CodeEmitter::getNativeMachine(unsigned int optLevel) {
 
 	std::string errorMsg("Target not supported.");
 	const llvm::Target* target = llvm::TargetRegistry::getClosestTargetForJIT(
@@ -30,21 +48,68 @@ llvm::TargetMachine* juli::CodeEmitter::getNativeMachine() {
 	llvm::TargetOptions opt;
 
 	llvm::TargetMachine* targetMachine = target->createTargetMachine(
-			targetTriple.getTriple(), cpu, "", opt);
+			targetTriple.getTriple(), cpu, "", opt, llvm::Reloc::Default,
+			llvm::CodeModel::Default, getCodeGenOptLevel(optLevel));
 
 	return targetMachine;
 }
 
-void juli::CodeEmitter::emitCode(const char* filename, llvm::Module* module,
+void juli::CodeEmitter::optimize(llvm::Module* module,
+		llvm::TargetMachine* machine) {
+	llvm::PassManagerBuilder builder;
+	builder.OptLevel = optLevel;
+	builder.SizeLevel = 0;
+	builder.DisableUnrollLoops = (optLevel == 0);
+	builder.LibraryInfo = new llvm::TargetLibraryInfo(
+			llvm::Triple(module->getTargetTriple()));
+
+	if (optLevel > 1) {
+		builder.Inliner = llvm::createFunctionInliningPass(
+				(optLevel > 2) ? 275 : 225);
+	} else {
+		builder.Inliner = llvm::createAlwaysInlinerPass();
+	}
+
+	// function level cleanup (mem2reg, early instcombine, ...):
+	llvm::FunctionPassManager functionPasses(module);
+	functionPasses.add(new llvm::TargetData(*machine->getTargetData()));
+	builder.populateFunctionPassManager(functionPasses);
+
+	functionPasses.doInitialization();
+	for (llvm::Module::iterator f = module->begin(); f != module->end(); ++f) {
+		functionPasses.run(*f);
+	}
+	functionPasses.doFinalization();
+
+	// module level pipeline (inlining, GVN, LICM, loop unrolling, ...):
+	llvm::PassManager modulePasses;
+	modulePasses.add(new llvm::TargetData(*machine->getTargetData()));
+	builder.populateModulePassManager(modulePasses);
+	modulePasses.run(*module);
+}
+
+bool juli::CodeEmitter::emitCode(const char* filename, llvm::Module* module,
 		llvm::TargetMachine* machine) {
 	std::ofstream os(filename, std::ios::out | std::ios::binary);
-	emitCode(os, module, machine);
+	bool result = emitCode(os, module, machine);
 	os.close();
+	return result && !os.fail();
 }
 
-void juli::CodeEmitter::emitCode(std::ostream& os, llvm::Module* module,
+bool juli::CodeEmitter::emitCode(std::ostream& os, llvm::Module* module,
 		llvm::TargetMachine* machine) {
 
+	bool ownsMachine = false;
+	if (!machine) {
+		machine = getNativeMachine(optLevel);
+		ownsMachine = true;
+	}
+
+	module->setTargetTriple(machine->getTargetTriple());
+	module->setDataLayout(machine->getTargetData()->getStringRepresentation());
+
+	optimize(module, machine);
+
 	llvm::raw_os_ostream ros(os);
 	llvm::formatted_raw_ostream fos(ros);
 
@@ -54,9 +119,14 @@ void juli::CodeEmitter::emitCode(std::ostream& os, llvm::Module* module,
 			llvm::TargetMachine::CGFT_ObjectFile);
 	if (b) {
 		printf("ERROR: cannot emit file");
+	} else {
+		passManager.run(*module);
 	}
 
-	passManager.run(*module);
-
 	fos.flush();
+	ros.flush();
+
+	if (ownsMachine)
+		delete machine;
+	return !b && !os.fail();
 }
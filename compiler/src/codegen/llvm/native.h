@@ -22,21 +22,37 @@
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/Program.h>
 #include <llvm/Support/PathV1.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
 #include "llvm/Support/Host.h"
 
 namespace juli {
 
 class CodeEmitter {
+private:
+	unsigned int optLevel;
+
+	void optimize(llvm::Module* module, llvm::TargetMachine* machine);
+
 public:
 
-	CodeEmitter(bool allTargets = false);
+	CodeEmitter(bool allTargets = false, unsigned int optLevel = 0);
+
+	unsigned int getOptLevel() const;
+
+	static llvm::CodeGenOpt::Level getCodeGenOptLevel(unsigned int optLevel);
 
-	static llvm::TargetMachine* getNativeMachine();
+	static llvm::TargetMachine* getNativeMachine(unsigned int optLevel = 0);
 
-	void emitCode(const char* filename, llvm::Module* module, llvm::TargetMachine* machine = getNativeMachine());
+	/*
+	 * Writes the module as object file. The output only depends on the module, the target machine and
+	 * the optimization level (not on time, paths or memory addresses), so objects can be cached by the
+	 * hash of their inputs. Returns false if the object could not be written.
+	 */
+	bool emitCode(const char* filename, llvm::Module* module, llvm::TargetMachine* machine = 0);
 
-	void emitCode(std::ostream& stream, llvm::Module* module, llvm::TargetMachine* machine = getNativeMachine());
+	bool emitCode(std::ostream& stream, llvm::Module* module, llvm::TargetMachine* machine = 0);
 
 };
 
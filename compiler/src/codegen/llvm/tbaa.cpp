@@ -0,0 +1,69 @@
+#include "tbaa.h"
+
+#include <sstream>
+#include <vector>
+
+#include <llvm/Constants.h>
+#include <llvm/DerivedTypes.h>
+
+using namespace juli;
+
+const int juli::TypeAliasInfo::HEADER_DATA = 0;
+const int juli::TypeAliasInfo::HEADER_LENGTH = 1;
+const int juli::TypeAliasInfo::HEADER_STRIDES = 2;
+
+juli::TypeAliasInfo::TypeAliasInfo(llvm::LLVMContext& context) :
+		context(context) {
+	root = llvm::MDNode::get(context, llvm::MDString::get(context, "juli tbaa"));
+	arrayHeader = getNode("array header", root);
+}
+
+llvm::MDNode* juli::TypeAliasInfo::getNode(const std::string& name, llvm::MDNode* parent, bool constant) {
+	llvm::MDNode* & node = nodes[name];
+	if (!node) {
+		std::vector<llvm::Value*> operands;
+		operands.push_back(llvm::MDString::get(context, name));
+		operands.push_back(parent);
+		if (constant)
+			operands.push_back(llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 1));
+		node = llvm::MDNode::get(context, operands);
+	}
+	return node;
+}
+
+llvm::MDNode* juli::TypeAliasInfo::getTypeNode(const Type* type) {
+	return getNode(type->mangle(), root);
+}
+
+llvm::MDNode* juli::TypeAliasInfo::getFieldNode(const ClassType* type, const Field* field) {
+	std::stringstream s;
+	s << type->mangle() << "." << field->name;
+	return getNode(s.str(), getTypeNode(field->type));
+}
+
+llvm::MDNode* juli::TypeAliasInfo::getElementNode(const ArrayType* type) {
+	std::stringstream s;
+	s << type->mangle() << "[]";
+	return getNode(s.str(), getTypeNode(type->getElementType()));
+}
+
+llvm::MDNode* juli::TypeAliasInfo::getHeaderNode(const ArrayType* type, int field) {
+	std::stringstream s;
+	s << type->mangle();
+	switch (field) {
+	case HEADER_DATA:
+		s << ".data";
+		break;
+	case HEADER_LENGTH:
+		s << ".length";
+		break;
+	default:
+		s << ".strides";
+		break;
+	}
+	return getNode(s.str(), arrayHeader, true);
+}
+
+bool juli::TypeAliasInfo::isConstant(const llvm::MDNode* node) {
+	return node->getNumOperands() > 2;
+}
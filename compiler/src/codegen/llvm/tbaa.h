@@ -0,0 +1,64 @@
+/*
+ * tbaa.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef TBAA_H_
+#define TBAA_H_
+
+#include <map>
+#include <string>
+
+#include <parser/ast/types.h>
+
+#include <llvm/LLVMContext.h>
+#include <llvm/Metadata.h>
+
+namespace juli {
+
+/*
+ * Builds the type based alias analysis tree for a module from the juli type hierarchy:
+ *
+ * root
+ *  +- primitive and reference types (one node per type)
+ *  |   +- array elements of that type (one node per array type)
+ *  |   +- class fields of that type (one node per field)
+ *  +- array header
+ *      +- data pointer / length / strides (one node per array type)
+ *
+ * Different fields and elements of different arrays never alias, even if they share a type.
+ * Array headers are never modified after their constructor returned, so the header nodes are
+ * marked constant, which lets the optimizer hoist .length and data pointer loads out of loops.
+ */
+class TypeAliasInfo {
+private:
+	llvm::LLVMContext& context;
+	llvm::MDNode* root;
+	llvm::MDNode* arrayHeader;
+
+	std::map<std::string, llvm::MDNode*> nodes;
+
+	llvm::MDNode* getNode(const std::string& name, llvm::MDNode* parent, bool constant = false);
+public:
+
+	static const int HEADER_DATA;
+	static const int HEADER_LENGTH;
+	static const int HEADER_STRIDES;
+
+	TypeAliasInfo(llvm::LLVMContext& context);
+
+	llvm::MDNode* getTypeNode(const Type* type);
+
+	llvm::MDNode* getFieldNode(const ClassType* type, const Field* field);
+
+	llvm::MDNode* getElementNode(const ArrayType* type);
+
+	llvm::MDNode* getHeaderNode(const ArrayType* type, int field);
+
+	static bool isConstant(const llvm::MDNode* node);
+};
+
+}
+
+#endif /* TBAA_H_ */
@@ -5,10 +5,12 @@
 
 using namespace juli;
 
+const unsigned int juli::TranslationUnit::ARRAY_ALIGNMENT = 64;
+
 juli::TranslationUnit::TranslationUnit(const std::string& name,
-		const TypeInfo& types) :
-		types(types) {
-	module = new llvm::Module(name, llvm::getGlobalContext());
+		const TypeInfo& types, ArrayLayout arrayLayout) :
+		context(new llvm::LLVMContext()), types(types), arrayLayout(arrayLayout) {
+	module = new llvm::Module(name, *context);
 }
 
 juli::TranslationUnit::~TranslationUnit() {
@@ -17,12 +19,40 @@ juli::TranslationUnit::~TranslationUnit() {
 			++i) {
 		delete *i;
 	}
+	delete context;
 }
 
 llvm::LLVMContext& juli::TranslationUnit::getContext() const {
 	return module->getContext();
 }
 
+ArrayLayout juli::TranslationUnit::getArrayLayout() const {
+	return arrayLayout;
+}
+
+unsigned int juli::TranslationUnit::getPointerSize() const {
+	switch (module->getPointerSize()) {
+	case llvm::Module::Pointer64:
+		return 8;
+	case llvm::Module::Pointer32:
+		return 4;
+	default:
+		return sizeof(void*); // no data layout yet: we compile for the host
+	}
+}
+
+unsigned int juli::TranslationUnit::getArrayHeaderSize(unsigned int dimension) const {
+	unsigned int size = getPointerSize() + 4 * dimension;
+	if (dimension > 1) {
+		size += 4 * (dimension - 1); // strides
+	}
+	if (arrayLayout == ARRAY_LAYOUT_INLINE) {
+		// round up, so the element data behind the header is aligned as well:
+		size = (size + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+	}
+	return size;
+}
+
 std::string juli::TranslationUnit::getLLVMTypeName(const Type* t) const {
 	std::stringstream s;
 	s << "type__" << t->mangle();
@@ -47,15 +77,7 @@ llvm::Type* juli::TranslationUnit::createClassType(const ClassType* t) const {
 }
 
 llvm::Type* juli::TranslationUnit::getPointerIntType() const {
-	llvm::LLVMContext& c = getContext();
-	switch (module->getPointerSize()) {
-	case llvm::Module::Pointer64:
-		return llvm::Type::getInt64Ty(c);
-	case llvm::Module::Pointer32:
-		return llvm::Type::getInt32Ty(c);
-	default:
-		return llvm::Type::getInt32Ty(c);
-	}
+	return llvm::IntegerType::get(getContext(), getPointerSize() * 8);
 }
 
 llvm::Type* juli::TranslationUnit::resolveLLVMType(const Type* t) const
@@ -86,37 +108,45 @@ llvm::Type* juli::TranslationUnit::resolveLLVMType(const Type* t) const
 
 	const ArrayType* at = dynamic_cast<const ArrayType*>(t);
 	if (at) {
-		if (*at->getElementType() == PrimitiveType::INT8_TYPE
-				&& at->getDimension() == 1) { // char array
-			return llvm::PointerType::get(resolveLLVMType(at->getElementType()),
-					0);
-		} else {
-			llvm::Type* t = getType(at);
-			if (!t) {
-				if (at->getStaticSize() >= 0 && at->getDimension() == 1) {
-					return llvm::PointerType::get(
-							llvm::ArrayType::get(
-									resolveLLVMType(at->getElementType()),
-									at->getStaticSize()), 0);
-				} else {
-					// create type:
-					std::vector<llvm::Type*> fields;
+		llvm::Type* t = getType(at);
+		if (!t) {
+			if (at->getStaticSize() >= 0 && at->getDimension() == 1) {
+				return llvm::PointerType::get(
+						llvm::ArrayType::get(
+								resolveLLVMType(at->getElementType()),
+								at->getStaticSize()), 0);
+			} else {
+				// create type:
+				std::vector<llvm::Type*> fields;
+				fields.push_back(
+						llvm::PointerType::get(
+								resolveLLVMType(at->getElementType()), 0));
+				if (at->getDimension() > 1) {
+					fields.push_back(
+							llvm::ArrayType::get(llvm::Type::getInt32Ty(c),
+									at->getDimension()));
+					// row-major strides, the last dimension always has stride 1:
 					fields.push_back(
-							llvm::PointerType::get(
-									resolveLLVMType(at->getElementType()), 0));
+							llvm::ArrayType::get(llvm::Type::getInt32Ty(c),
+									at->getDimension() - 1));
+				} else {
+					fields.push_back(llvm::Type::getInt32Ty(c));
+				}
+				if (arrayLayout == ARRAY_LAYOUT_INLINE) {
+					// pad the header, the element data starts right behind it:
+					unsigned int used = getPointerSize() + 4 * at->getDimension();
 					if (at->getDimension() > 1) {
-						fields.push_back(
-								llvm::ArrayType::get(llvm::Type::getInt32Ty(c),
-										at->getDimension()));
-					} else {
-						fields.push_back(llvm::Type::getInt32Ty(c));
+						used += 4 * (at->getDimension() - 1);
+					}
+					unsigned int padding = getArrayHeaderSize(at->getDimension()) - used;
+					if (padding > 0) {
+						fields.push_back(llvm::ArrayType::get(llvm::Type::getInt8Ty(c), padding));
 					}
-					t = llvm::StructType::create(fields, getLLVMTypeName(at));
 				}
+				t = llvm::StructType::create(fields, getLLVMTypeName(at));
 			}
-			return llvm::PointerType::get(t, 0);
 		}
-
+		return llvm::PointerType::get(t, 0);
 	}
 
 	const ClassType* ct = dynamic_cast<const ClassType*>(t);
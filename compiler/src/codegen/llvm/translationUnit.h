@@ -24,14 +24,22 @@
 
 namespace juli {
 
+	enum ArrayLayout {
+		ARRAY_LAYOUT_SPLIT, // header and element data in separate allocations
+		ARRAY_LAYOUT_INLINE // element data follows the header in the same, aligned allocation
+	};
+
 	class TranslationUnit {
 	private:
-		StatementList statements;
+		// every translation unit has its own context, so they can be generated concurrently:
+		llvm::LLVMContext* context;
 
-		std::map<std::string, llvm::Value*> llvmSymbolTable;
+		StatementList statements;
 
 		const TypeInfo& types;
 
+		ArrayLayout arrayLayout;
+
 		mutable std::vector<CompilerError> compilerErrors;
 
 		std::string getLLVMTypeName(const Type* t) const;
@@ -41,34 +49,24 @@ namespace juli {
 
 		llvm::Type* getPointerIntType() const;
 	public:
+		static const unsigned int ARRAY_ALIGNMENT;
+
 		llvm::Module* module;
 
-		TranslationUnit(const std::string& name, const TypeInfo& types);
+		TranslationUnit(const std::string& name, const TypeInfo& types, ArrayLayout arrayLayout = ARRAY_LAYOUT_SPLIT);
 
 		~TranslationUnit();
 
 		llvm::LLVMContext& getContext() const;
 
-		llvm::Type* resolveLLVMType(const Type* t) const throw (CompilerError);
-		llvm::Type* resolveLLVMType(const NType* t) const throw (CompilerError);
+		ArrayLayout getArrayLayout() const;
 
-		llvm::Value* getSymbol(const std::string& name, const Node* n) {
-			try {
-				return llvmSymbolTable.at(name);
-			} catch (std::out_of_range& e) {
-				CompilerError err(n);
-				err.getStream() << "Unknown symbol " << name;
-				throw err;
-			}
-		}
+		unsigned int getPointerSize() const;
 
-		void addSymbol(const std::string& name, llvm::Value* value) {
-			llvmSymbolTable[name] = value;
-		}
+		unsigned int getArrayHeaderSize(unsigned int dimension) const;
 
-		void removeSymbol(const std::string& name) {
-			llvmSymbolTable.erase(name);
-		}
+		llvm::Type* resolveLLVMType(const Type* t) const throw (CompilerError);
+		llvm::Type* resolveLLVMType(const NType* t) const throw (CompilerError);
 
 		const std::vector<CompilerError>& getErrors() const {
 			return compilerErrors;
@@ -1,14 +1,14 @@
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <set>
+#include <sstream>
+#include <vector>
 
-#include <parser/parser.h>
 #include <codegen/llvm/native.h>
-#include <debug/print.h>
-#include <parser/ast/node.h>
-#include <analysis/type/declare.h>
-#include <analysis/type/typecheck.h>
-#include <codegen/llvm/ir.h>
-#include <builder/builder.h>
+#include <builder/build.h>
+#include <builder/compiler.h>
+#include <builder/server.h>
+#include <profile/profiler.h>
 
 #include <llvm/Support/CommandLine.h>
 
@@ -17,61 +17,164 @@ using namespace juli;
 
 using std::cerr;
 
-cl::opt<string> inputFilename(cl::Positional, cl::desc("<input file>"), cl::Required);
-cl::opt<string> outputFilename("o", cl::desc("Specify output filename"), cl::value_desc("filename"), cl::Required);
+cl::list<string> inputFilenames(cl::Positional, cl::desc("<input files>"), cl::ZeroOrMore);
+cl::opt<string> outputFilename("o", cl::desc("Specify output filename (output directory for several inputs)"),
+		cl::value_desc("filename"));
+cl::opt<unsigned int> threads("j", cl::desc("Number of files to compile in parallel"), cl::value_desc("N"),
+		cl::init(1));
 cl::opt<string> outputIRFilename("irtext", cl::desc("Output ir assembly code"), cl::value_desc("filename"));
 cl::opt<string> outputASTFilename("ast", cl::desc("Output debug ast"), cl::value_desc("filename"));
+cl::opt<string> outputInterfaceFilename("interface",
+		cl::desc("Output the module interface (default: next to the input, <module>.jli)"), cl::value_desc("filename"));
+cl::opt<bool> noInterface("no-interface", cl::desc("Do not write a module interface"));
+cl::opt<char> optLevel("O", cl::desc("Optimization level. [-O0, -O1, -O2, or -O3] (default = '-O0')"), cl::Prefix,
+		cl::ZeroOrMore, cl::init('0'));
+cl::opt<ArrayLayout> arrayLayout("array-layout", cl::desc("Memory layout of dynamic arrays (all modules must agree)"),
+		cl::values(clEnumValN(ARRAY_LAYOUT_SPLIT, "split", "header and data in separate allocations (default)"),
+				clEnumValN(ARRAY_LAYOUT_INLINE, "inline", "header and 64 byte aligned data in one allocation"),
+				clEnumValEnd), cl::init(ARRAY_LAYOUT_SPLIT));
+cl::opt<FrontEnd> frontEnd("parser", cl::desc("Front end used to parse the sources"),
+		cl::values(clEnumValN(FRONT_END_ANTLR, "antlr", "the parser generated from JL.g (default)"),
+				clEnumValN(FRONT_END_FAST, "fast", "the hand-written parser"),
+				clEnumValN(FRONT_END_COMPARE, "compare", "only parse with both, exit status 3 if their -ast dumps differ"), clEnumValEnd),
+		cl::init(FRONT_END_ANTLR));
+cl::opt<bool> serverMode("server", cl::desc("Run as compile server, keeping imported modules and the target warm"));
+cl::opt<bool> useServer("use-server", cl::desc("Compile through a running compile server"));
+cl::opt<bool> stopServerMode("stop-server", cl::desc("Stop a running compile server"));
+cl::opt<string> serverSocket("server-socket", cl::desc("Unix socket of the compile server (default /tmp/jlc-<uid>.sock)"),
+		cl::value_desc("path"));
+cl::opt<string> buildDir("build-dir", cl::desc("Directory for objects and build state of jlc build (default .)"),
+		cl::value_desc("directory"), cl::init("."));
+cl::opt<string> linker("linker", cl::desc("Linker used by jlc build (default g++)"), cl::value_desc("program"),
+		cl::init("g++"));
+cl::opt<string> cacheDir("cache-dir", cl::desc("Reuse objects compiled from the same inputs from this directory"),
+		cl::value_desc("directory"));
+cl::opt<unsigned int> cacheSize("cache-size", cl::desc("Maximum size of the object cache in MB (default 1024)"),
+		cl::value_desc("MB"), cl::init(1024));
+cl::opt<bool> cacheStats("cache-stats", cl::desc("Print object cache hits and misses"));
+cl::opt<bool> timeReport("ftime-report",
+		cl::desc("Print wall time, CPU time and allocations of each compiler phase and imported module"));
+cl::opt<string> traceFilename("ftrace", cl::desc("Write a Chrome trace (chrome://tracing) of the compilation"),
+		cl::value_desc("filename"));
+
+static std::string getConfiguration() {
+	std::stringstream s;
+	s << "-O" << (char) optLevel << " --array-layout=" << ((arrayLayout == ARRAY_LAYOUT_INLINE) ? "inline" : "split");
+	return s.str();
+}
+
+static bool hasExtension(const std::string& filename, const std::string& extension) {
+	return filename.size() > extension.size()
+			&& filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+static std::string getObjectFilename(const std::string& input) {
+	std::string base = hasExtension(input, ".jl") ? input.substr(0, input.size() - 3) : input;
+	if (outputFilename.empty())
+		return base + ".o";
+	// -o names the output directory if there are several inputs:
+	size_t slash = base.rfind('/');
+	return outputFilename + "/" + ((slash == std::string::npos) ? base : base.substr(slash + 1)) + ".o";
+}
 
 int main(int argc, char **argv) {
 	int result = 0;
 
-	cl::ParseCommandLineOptions(argc, argv);
+	// jlc build [sources or directories] -o <executable>
+	bool buildMode = argc > 1 && std::string(argv[1]) == "build";
+	if (buildMode) {
+		argv[1] = argv[0];
+		--argc;
+		++argv;
+	}
 
-	CodeEmitter emitter;
-	Importer importer;
-	Parser parser;
+	cl::ParseCommandLineOptions(argc, argv);
 
-	importer.add(new SourceImportLoader(parser, importer));
-	try {
-		Node* ast = parser.parse(inputFilename);
+	if (optLevel < '0' || optLevel > '3') {
+		cerr << argv[0] << ": invalid optimization level -O" << optLevel << std::endl;
+		return 1;
+	}
 
-		Declarator declarator(importer);
-		TypeInfo* typeInfo = declarator.declare(ast);
-		typeInfo->resolveClasses();
+	Parser::setFrontEnd(frontEnd);
 
-		TypeChecker typeChecker(*typeInfo);
-		typeChecker.visit(ast);
+	std::string socketPath = serverSocket.empty() ? CompileServer::getDefaultSocket() : serverSocket;
 
-		if (!outputASTFilename.empty()) {
-			std::ofstream astos(outputASTFilename.c_str());
-			ast->print(astos, 0, Indentable::FLAG_TREE);
+	bool single = inputFilenames.size() == 1;
+	if (!serverMode && !stopServerMode && !buildMode) {
+		// --parser=compare writes no output:
+		if (inputFilenames.empty() || (single && outputFilename.empty() && frontEnd != FRONT_END_COMPARE)) {
+			cerr << argv[0] << ": an input file and an output file (-o) are required" << std::endl;
+			return 1;
 		}
-
-		IRGenerator irgen("test", *typeInfo);
-		irgen.process(ast);
-
-		if (!outputIRFilename.empty()) {
-			std::ofstream iros(outputIRFilename.c_str());
-			llvm::raw_os_ostream ros(iros);
-			irgen.getTranslationUnit().module->print(ros, 0);
+		if (!single && (!outputIRFilename.empty() || !outputASTFilename.empty() || !outputInterfaceFilename.empty())) {
+			cerr << argv[0] << ": -irtext, -ast and -interface require a single input file" << std::endl;
+			return 1;
 		}
+	}
 
+	Profiler* profiler = (timeReport || !traceFilename.empty()) ? new Profiler(timeReport, traceFilename) : 0;
+
+	std::vector<CompileJob> jobs;
+	std::set<std::string> outputs;
+	for (cl::list<string>::iterator i = inputFilenames.begin(); i != inputFilenames.end(); ++i) {
+		CompileJob job;
+		job.inputFilename = *i;
+		job.outputFilename = single ? outputFilename : getObjectFilename(*i);
+		// e.g. a/util.jl and b/util.jl with -o <dir>, their compiles would overwrite each other's object:
+		if (!buildMode && !outputs.insert(job.outputFilename).second) {
+			cerr << argv[0] << ": several inputs are compiled to " << job.outputFilename << std::endl;
+			return 1;
+		}
+		job.outputIRFilename = outputIRFilename;
+		job.outputASTFilename = outputASTFilename;
+		if (!noInterface) {
+			job.outputInterfaceFilename = outputInterfaceFilename;
+			if (job.outputInterfaceFilename.empty() && hasExtension(job.inputFilename, ".jl"))
+				job.outputInterfaceFilename = job.inputFilename + "i";
+		}
+		jobs.push_back(job);
+	}
 
-		if (irgen.getTranslationUnit().getErrors().empty()) {
-			emitter.emitCode(outputFilename.c_str(), irgen.getTranslationUnit().module);
+	try {
+		if (stopServerMode) {
+			stopServer(socketPath);
+		} else if (useServer) {
+			for (std::vector<CompileJob>::iterator i = jobs.begin(); i != jobs.end(); ++i) {
+				result = std::max(result, compileRemote(socketPath, getConfiguration(), *i, cerr));
+			}
 		} else {
-			std::vector<CompilerError> errors = irgen.getTranslationUnit().getErrors();
-			for (std::vector<CompilerError>::iterator i = errors.begin(); i != errors.end(); ++i) {
-				std::cerr << *i;
+			CodeEmitter emitter(false, optLevel - '0');
+			Importer importer;
+			Compiler::initImporter(importer);
+			ObjectCache* cache = cacheDir.empty() ? 0 : new ObjectCache(cacheDir, (uint64_t) cacheSize << 20);
+			if (buildMode) {
+				BuildDriver driver(emitter, arrayLayout, importer, buildDir, threads, linker, cache);
+				if (inputFilenames.empty())
+					driver.add(".");
+				for (cl::list<string>::iterator i = inputFilenames.begin(); i != inputFilenames.end(); ++i) {
+					driver.add(*i);
+				}
+				result = driver.build(outputFilename.empty() ? "a.out" : outputFilename, cerr);
+			} else if (serverMode) {
+				Compiler compiler(emitter, arrayLayout, importer, cache);
+				CompileServer server(compiler, socketPath, getConfiguration());
+				server.run();
+			} else {
+				result = compileAll(emitter, arrayLayout, importer, jobs, threads, cerr, cache);
 			}
-			result = 1;
+			if (cache && cacheStats)
+				cache->printStatistics(cerr);
+			delete cache;
 		}
-
-		delete typeInfo;
-
-	} catch (Error& ce) {
-		cerr << "Uncaught error: " << ce;
+	} catch (Error& e) {
+		cerr << argv[0] << ": " << e << std::endl;
 		result = 2;
 	}
+
+	if (profiler) {
+		profiler->printReport(cerr);
+		profiler->writeTrace();
+		delete profiler;
+	}
 	return result;
 }
@@ -18,12 +18,13 @@ options {
 }
 
 @postinclude {
-  std::string filename;
+  // the id of the file being parsed (see juli::SourceFiles):
+  static __thread uint32_t file;
 }
 
-translation_unit[const std::string& fn] returns [juli::NBlock* result = 0]:
+translation_unit[uint32_t fileId] returns [juli::NBlock* result = 0]:
 {
-  filename = fn;
+  file = fileId;
   result = new juli::NBlock();
 }
 (stmt=statement { result->addStatement(stmt); })+ 
@@ -48,7 +49,7 @@ import_statement returns [juli::NStatement* result = 0]:
 IMPORT id=identifier SCOL
 {
   result = new juli::NImportStatement(id);
-  setSourceLoc(result, filename, $IMPORT, $SCOL);
+  setSourceLoc(result, file, $IMPORT, $SCOL);
 }
 ;
 
@@ -63,7 +64,7 @@ OCBR
 CCBR
 {
   result = new juli::NClassDefinition(id, fields);
-  setSourceLoc(result, filename, $STRUCT, $CCBR);
+  setSourceLoc(result, file, $STRUCT, $CCBR);
 }
 ;
 
@@ -99,7 +100,7 @@ OCBR
 (stmt=statement { result->addStatement(stmt); })*
 CCBR
 {
-  setSourceLoc(result, filename, $OCBR, $CCBR);
+  setSourceLoc(result, file, $OCBR, $CCBR);
 }
 ;
 
@@ -161,7 +162,7 @@ CPAR
 {
   result = new juli::NFunctionSignature(type, name, arguments, varArgs, (cmod) ? juli::MODIFIER_C : 0);
   if (cmod) {
-    setSourceLoc(result, filename, $C_MOD, $CPAR);
+    setSourceLoc(result, file, $C_MOD, $CPAR);
   } else {
     setSourceLoc(result, sign, $CPAR);
   }
@@ -197,7 +198,7 @@ RETURN
 SCOL
 {
   result = new juli::NReturnStatement(exp);
-  setSourceLoc(result, filename, $RETURN, $SCOL);
+  setSourceLoc(result, file, $RETURN, $SCOL);
 }
 ;
 
@@ -335,13 +336,13 @@ unary returns [juli::NExpression* result = 0]
       if (current) {
         juli::NUnaryOperator* uop = new juli::NUnaryOperator(0, type);
         current->expression = uop;
-        setSourceLoc(uop, filename, operatorToken);
+        setSourceLoc(uop, file, operatorToken);
         setSourceLoc(current, current, uop);
         current = uop;
         
       } else {
         current = new juli::NUnaryOperator(0, type);
-        setSourceLoc(current, filename, operatorToken);
+        setSourceLoc(current, file, operatorToken);
       }
     }
   )*
@@ -417,7 +418,7 @@ t=type
 (COMMA i=expression { indices.push_back(i); })* CSBR 
 { 
   result = new juli::NAllocateArray(t, indices);
-  setSourceLoc(result, filename, $NEW, $CSBR);
+  setSourceLoc(result, file, $NEW, $CSBR);
 }
 )
 ;
@@ -438,7 +439,7 @@ val=function_call { result = val; } |
 OPAR val=expression CPAR 
 { 
   result = val;
-  setSourceLoc(result, filename, $OPAR, $CPAR); 
+  setSourceLoc(result, file, $OPAR, $CPAR); 
 }
 ;
 
@@ -515,7 +516,7 @@ identifier returns [juli::NIdentifier* result = 0]:
 Identifier 
 {
   result = new juli::NIdentifier(getTokenString($Identifier)); 
-  setSourceLoc(result, filename, $Identifier);
+  setSourceLoc(result, file, $Identifier);
 } 
 ;
 
@@ -526,7 +527,7 @@ FloatingPointLiteral
   double value = 0.0;
   valueStr >> value;
   result = new juli::NLiteral<double>(juli::DOUBLE_LITERAL, value, &juli::PrimitiveType::FLOAT64_TYPE); 
-  setSourceLoc(result, filename, $FloatingPointLiteral);
+  setSourceLoc(result, file, $FloatingPointLiteral);
 } 
 ;
 
@@ -536,7 +537,7 @@ StringLiteral
   std::string tokenText = getTokenString($StringLiteral);
   tokenText = tokenText.substr(1, tokenText.size() - 2);
   result = new juli::NStringLiteral(tokenText);
-  setSourceLoc(result, filename, $StringLiteral);
+  setSourceLoc(result, file, $StringLiteral);
 }
 ;
 
@@ -546,7 +547,7 @@ CharacterLiteral
   std::string tokenText = getTokenString($CharacterLiteral);
   tokenText = tokenText.substr(1, tokenText.size() - 2);
   result = new juli::NCharLiteral(tokenText);
-  setSourceLoc(result, filename, $CharacterLiteral);
+  setSourceLoc(result, file, $CharacterLiteral);
 }
 ;
 
@@ -554,12 +555,12 @@ boolean_literal returns [juli::NExpression* result = 0]:
   TRUE    
   { 
     result = new juli::NLiteral<bool>(juli::BOOLEAN_LITERAL, true, &juli::PrimitiveType::BOOLEAN_TYPE); 
-    setSourceLoc(result, filename, $TRUE);
+    setSourceLoc(result, file, $TRUE);
   } 
 | FALSE   
 { 
   result = new juli::NLiteral<bool>(juli::BOOLEAN_LITERAL, false, &juli::PrimitiveType::BOOLEAN_TYPE); 
-  setSourceLoc(result, filename, $FALSE);
+  setSourceLoc(result, file, $FALSE);
 } 
 ;
 
@@ -567,7 +568,7 @@ null_literal returns [juli::NExpression* result = 0]:
   NIL    
   { 
     result = new juli::NLiteral<int>(juli::NULL_LITERAL, 0, &juli::PrimitiveType::NULL_TYPE); 
-    setSourceLoc(result, filename, $NIL);
+    setSourceLoc(result, file, $NIL);
   }
 ;
 
@@ -579,7 +580,7 @@ DecimalLiteral
   uint64_t value = 0;
   valueStr >> value;
   result = new juli::NLiteral<uint64_t>(juli::INTEGER_LITERAL, value, &juli::PrimitiveType::INT32_TYPE);
-  setSourceLoc(result, filename, $DecimalLiteral);
+  setSourceLoc(result, file, $DecimalLiteral);
 }
 ;
 
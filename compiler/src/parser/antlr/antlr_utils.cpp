@@ -9,43 +9,43 @@ std::string getTokenString(pANTLR3_COMMON_TOKEN token) {
 	return std::string(getTokenText(token));
 }
 
-void setSourceLoc(juli::Indentable* node, const std::string& filename,
-		pANTLR3_COMMON_TOKEN token) {
-	juli::Marker start = getSourceMarker(token);
-	juli::Marker end = getSourceMarker(token, true);
+static __thread ANTLR3_MARKER inputStart = 0;
+
+void setSourceInput(pANTLR3_INPUT_STREAM input) {
+	inputStart = (ANTLR3_MARKER) input->data;
+}
+
+static uint32_t getStartOffset(pANTLR3_COMMON_TOKEN token) {
+	return token->getStartIndex(token) - inputStart;
+}
+
+static uint32_t getEndOffset(pANTLR3_COMMON_TOKEN token) {
+	return token->getStopIndex(token) - inputStart + 1;
+}
 
-	node->setSourceLocation(filename, start, end);
+void setSourceLoc(juli::Indentable* node, uint32_t file,
+		pANTLR3_COMMON_TOKEN token) {
+	node->setSourceLocation(juli::SourceLocation(file, getStartOffset(token), getEndOffset(token)));
 }
 
 void setSourceLoc(juli::Indentable* node, juli::Indentable* first,
 		juli::Indentable* last) {
-	node->setSourceLocation(first->filename, first->start, last->end);
+	node->setSourceLocation(juli::SourceLocation(first->location.file, first->location.start, last->location.end));
 }
 
 void setSourceLoc(juli::Indentable* node, juli::Indentable* first,
 		pANTLR3_COMMON_TOKEN last) {
-	node->setSourceLocation(first->filename, first->start, getSourceMarker(last, true));
+	node->setSourceLocation(juli::SourceLocation(first->location.file, first->location.start, getEndOffset(last)));
 }
 
 void setSourceLoc(juli::Indentable* node, pANTLR3_COMMON_TOKEN first,
 		juli::Indentable* last) {
-	node->setSourceLocation(last->filename, getSourceMarker(first), last->end);
+	node->setSourceLocation(juli::SourceLocation(last->location.file, getStartOffset(first), last->location.end));
 }
 
-void setSourceLoc(juli::Indentable* node, const std::string& filename,
+void setSourceLoc(juli::Indentable* node, uint32_t file,
 		pANTLR3_COMMON_TOKEN first, pANTLR3_COMMON_TOKEN last) {
-	node->setSourceLocation(filename, getSourceMarker(first), getSourceMarker(last, true));
-}
-
-juli::Marker getSourceMarker(pANTLR3_COMMON_TOKEN token, bool end) {
-	unsigned int line = token->getLine(token);
-	unsigned int column = token->getCharPositionInLine(token) + 1;
-	if (end) {
-		unsigned long tokenLength = token->getStopIndex(token)
-					- token->getStartIndex(token) + 1;
-		column += tokenLength;
-	}
-	return juli::Marker(line, column);
+	node->setSourceLocation(juli::SourceLocation(file, getStartOffset(first), getEndOffset(last)));
 }
 
 pANTLR3_STRING getString(const char* s) {
@@ -16,7 +16,12 @@ char* getTokenText(pANTLR3_COMMON_TOKEN token);
 
 std::string getTokenString(pANTLR3_COMMON_TOKEN token);
 
-void setSourceLoc(juli::Indentable* node, const std::string& filename, pANTLR3_COMMON_TOKEN token);
+/*
+ * Token positions are turned into offsets relative to the start of this input.
+ */
+void setSourceInput(pANTLR3_INPUT_STREAM input);
+
+void setSourceLoc(juli::Indentable* node, uint32_t file, pANTLR3_COMMON_TOKEN token);
 
 void setSourceLoc(juli::Indentable* node, juli::Indentable* first, juli::Indentable* last);
 
@@ -24,9 +29,7 @@ void setSourceLoc(juli::Indentable* node, juli::Indentable* first, pANTLR3_COMMO
 
 void setSourceLoc(juli::Indentable* node, pANTLR3_COMMON_TOKEN first, juli::Indentable* last);
 
-void setSourceLoc(juli::Indentable* node, const std::string& filename, pANTLR3_COMMON_TOKEN first, pANTLR3_COMMON_TOKEN last);
-
-juli::Marker getSourceMarker(pANTLR3_COMMON_TOKEN token, bool end = false);
+void setSourceLoc(juli::Indentable* node, uint32_t file, pANTLR3_COMMON_TOKEN first, pANTLR3_COMMON_TOKEN last);
 
 pANTLR3_STRING getString(const char* s);
 
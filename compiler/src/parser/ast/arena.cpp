@@ -0,0 +1,122 @@
+#include "arena.h"
+
+#include <new>
+
+#include <parser/ast/node.h>
+
+using namespace juli;
+
+__thread AstArena* AstArena::current = 0;
+
+const size_t juli::AstArena::CHUNK_SIZE = 64 * 1024;
+
+/*
+ * Precedes every node, so operator delete knows where the node came from (0 for the heap). Its size
+ * keeps the nodes 8 byte aligned.
+ */
+union NodeHeader {
+	AstArena* arena;
+	double alignDouble;
+	long long alignLong;
+};
+
+static size_t align(size_t size) {
+	return (size + sizeof(NodeHeader) - 1) & ~(sizeof(NodeHeader) - 1);
+}
+
+juli::AstArena::Scope::Scope(AstArena& arena) :
+		previous(current) {
+	current = &arena;
+}
+
+juli::AstArena::Scope::~Scope() {
+	current = previous;
+}
+
+juli::AstArena::AstArena() :
+		used(CHUNK_SIZE), allocated(0) {
+}
+
+juli::AstArena::~AstArena() {
+	release();
+}
+
+AstArena* juli::AstArena::getCurrent() {
+	return current;
+}
+
+void* juli::AstArena::allocate(size_t size) {
+	size = align(size);
+	char* p;
+	if (size > CHUNK_SIZE / 4) {
+		// large nodes get a chunk of their own, so the current chunk is not wasted:
+		p = static_cast<char*>(::operator new(size));
+		chunks.insert(chunks.end() - (chunks.empty() ? 0 : 1), p);
+	} else {
+		if (used + size > CHUNK_SIZE) {
+			chunks.push_back(static_cast<char*>(::operator new(CHUNK_SIZE)));
+			used = 0;
+		}
+		p = chunks.back() + used;
+		used += size;
+	}
+	allocated += size;
+	nodes.push_back(p);
+	return p;
+}
+
+void juli::AstArena::remove(void* node) {
+	for (std::vector<void*>::reverse_iterator i = nodes.rbegin(); i != nodes.rend(); ++i) {
+		if (*i == node) {
+			nodes.erase(--i.base());
+			return;
+		}
+	}
+}
+
+void juli::AstArena::release() {
+	// nodes don't own their children, so every node is destroyed exactly once here:
+	for (std::vector<void*>::reverse_iterator i = nodes.rbegin(); i != nodes.rend(); ++i) {
+		Indentable* node = reinterpret_cast<Indentable*>(static_cast<char*>(*i) + sizeof(NodeHeader));
+		node->~Indentable();
+	}
+	nodes.clear();
+
+	for (std::vector<char*>::iterator i = chunks.begin(); i != chunks.end(); ++i) {
+		::operator delete(*i);
+	}
+	chunks.clear();
+	used = CHUNK_SIZE;
+	allocated = 0;
+
+	for (std::vector<uint32_t>::iterator i = files.begin(); i != files.end(); ++i) {
+		SourceFiles::remove(*i);
+	}
+	files.clear();
+}
+
+void juli::AstArena::addFile(uint32_t file) {
+	files.push_back(file);
+}
+
+size_t juli::AstArena::getSize() const {
+	return allocated;
+}
+
+void* juli::Indentable::operator new(size_t size) {
+	AstArena* arena = AstArena::getCurrent();
+	NodeHeader* header = static_cast<NodeHeader*>(
+			arena ? arena->allocate(sizeof(NodeHeader) + size) : ::operator new(sizeof(NodeHeader) + size));
+	header->arena = arena;
+	return header + 1;
+}
+
+void juli::Indentable::operator delete(void* p) {
+	if (!p)
+		return;
+	NodeHeader* header = static_cast<NodeHeader*>(p) - 1;
+	if (header->arena)
+		header->arena->remove(header);
+	else
+		::operator delete(header);
+}
@@ -0,0 +1,85 @@
+/*
+ * arena.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace juli {
+
+class Indentable;
+
+/*
+ * Owns the AST nodes of one compilation (or one imported module). Nodes are placed one after another
+ * in large chunks instead of being allocated one by one, and are all destroyed and released together
+ * with the arena.
+ *
+ * Indentable::operator new allocates in the arena the calling thread currently uses (see
+ * AstArena::Scope), or on the heap if there is none. Arena nodes must not outlive their arena; deleting
+ * one explicitly is allowed but not necessary.
+ */
+class AstArena {
+private:
+	static __thread AstArena* current;
+
+	static const size_t CHUNK_SIZE;
+
+	std::vector<char*> chunks;
+	size_t used;
+	size_t allocated;
+
+	// in order of allocation, destroyed in reverse order:
+	std::vector<void*> nodes;
+
+	// the source files the nodes refer to (see SourceFiles):
+	std::vector<uint32_t> files;
+
+	AstArena(const AstArena& copy);
+	void operator=(const AstArena& copy);
+public:
+
+	class Scope {
+	private:
+		AstArena* previous;
+	public:
+		Scope(AstArena& arena);
+		~Scope();
+	};
+
+	AstArena();
+	~AstArena();
+
+	static AstArena* getCurrent();
+
+	/*
+	 * Memory for a node, which is destroyed with the arena.
+	 */
+	void* allocate(size_t size);
+
+	/*
+	 * Forgets a node that was destroyed (or never constructed) before the arena.
+	 */
+	void remove(void* node);
+
+	/*
+	 * Removes the source file when the arena is released.
+	 */
+	void addFile(uint32_t file);
+
+	/*
+	 * Destroys all nodes and releases their memory. The arena can be used again afterwards.
+	 */
+	void release();
+
+	size_t getSize() const;
+};
+
+}
+
+#endif /* ARENA_H_ */
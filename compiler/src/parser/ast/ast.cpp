@@ -9,7 +9,7 @@ using namespace juli;
 
 juli::NBasicType::NBasicType(NIdentifier* id) :
 		name(id->name) {
-	setSourceLocation(id->filename, id->start, id->end);
+	setSourceLocation(id->location);
 }
 
 void juli::NBasicType::print(std::ostream& os, int indent, unsigned int flags) const {
@@ -22,7 +22,16 @@ void juli::NBasicType::print(std::ostream& os, int indent, unsigned int flags) c
 	}
 }
 
-const Type* NBasicType::resolve(const TypeInfo& types) const throw (CompilerError) {
+const Type* juli::NType::resolve(const TypeInfo& types) const throw (CompilerError) {
+	// types are interned, so a node always resolves to the same type in the same scope:
+	if (resolvedIn != &types) {
+		resolved = resolveType(types);
+		resolvedIn = &types;
+	}
+	return resolved;
+}
+
+const Type* NBasicType::resolveType(const TypeInfo& types) const throw (CompilerError) {
 	return types.getType(name, this);
 }
 
@@ -42,8 +51,8 @@ void juli::NArrayType::print(std::ostream& os, int indent, unsigned int flags) c
 	}
 }
 
-const Type* NArrayType::resolve(const TypeInfo& types) const throw (CompilerError) {
-	return new ArrayType(elementType->resolve(types), dimension);
+const Type* NArrayType::resolveType(const TypeInfo& types) const throw (CompilerError) {
+	return TypeContext::getArray(elementType->resolve(types), dimension);
 }
 
 juli::NExpression::NExpression(NodeType nodeType, const Type* expressionType) :
@@ -69,7 +78,7 @@ NAddressable::NAddressable(NodeType nodeType) :
 }
 
 juli::NStringLiteral::NStringLiteral(std::string value) :
-		NLiteral<std::string>(STRING_LITERAL, value, new ArrayType(&PrimitiveType::INT8_TYPE)) {
+		NLiteral<std::string>(STRING_LITERAL, value, TypeContext::getArray(&PrimitiveType::INT8_TYPE)) {
 
 	std::stringstream sstream;
 	unsigned char escCount = 0;
@@ -129,7 +138,7 @@ juli::NQualifiedAccess::NQualifiedAccess(NExpression* ref, NIdentifier* name) :
 }
 
 juli::NQualifiedAccess::NQualifiedAccess(NExpression* ref, NVariableRef* name) :
-		NAddressable(QUALIFIED_ACCESS), ref(ref), name(new NIdentifier(name->name)), index(-1) {
+		NAddressable(QUALIFIED_ACCESS), ref(ref), name(new NIdentifier(name->symbol)), index(-1) {
 }
 
 void juli::NQualifiedAccess::print(std::ostream& os, int indent, unsigned int flags) const {
@@ -201,7 +210,11 @@ void juli::NAllocateObject::print(std::ostream& os, int indent, unsigned int fla
 }
 
 juli::NIdentifier::NIdentifier(const std::string& name) :
-		name(name) {
+		name(name), symbol(name) {
+}
+
+juli::NIdentifier::NIdentifier(const Symbol& symbol) :
+		name(symbol.str()), symbol(symbol) {
 }
 
 void juli::NIdentifier::print(std::ostream& os, int indent, unsigned int flags) const {
@@ -224,8 +237,8 @@ juli::NIdentifier::operator const std::string() const {
 }
 
 juli::NVariableRef::NVariableRef(NIdentifier* id) :
-		NAddressable(VARIABLE_REF), name(id->name) {
-	setSourceLocation(id->filename, id->start, id->end);
+		NAddressable(VARIABLE_REF), name(id->name), symbol(id->symbol), slot(-1) {
+	setSourceLocation(id->location);
 }
 
 void juli::NVariableRef::print(std::ostream& os, int indent, unsigned int flags) const {
@@ -242,9 +255,7 @@ void juli::NVariableRef::print(std::ostream& os, int indent, unsigned int flags)
 juli::NCast::NCast(NExpression* expression, NType* target) :
 		NExpression(CAST), expression(expression), target(target) {
 	if (!target) {
-		filename = expression->filename;
-		start = expression->start;
-		end = expression->end;
+		location = expression->location;
 	}
 }
 
@@ -399,7 +410,7 @@ void juli::NBlock::print(std::ostream& os, int indent, unsigned int flags) const
 }
 
 juli::NVariableDeclaration::NVariableDeclaration(NType* type, NIdentifier* name, NExpression *assignmentExpr) :
-		NStatement(VARIABLE_DECL), name(name), type(type), assignmentExpr(assignmentExpr) {
+		NStatement(VARIABLE_DECL), name(name), type(type), assignmentExpr(assignmentExpr), slot(-1) {
 }
 
 void juli::NVariableDeclaration::print(std::ostream& os, int indent, unsigned int flags) const {
@@ -13,6 +13,7 @@
 #include <parser/ast/node.h>
 #include <parser/ast/types.h>
 #include <analysis/error.h>
+#include <analysis/symbol.h>
 
 namespace juli {
 
@@ -22,9 +23,13 @@ class Function;
 class NIdentifier : public Indentable {
 public:
 	std::string name;
+	// interned when the node is built, so the analysis compares names by pointer:
+	Symbol symbol;
 
 	NIdentifier(const std::string& name);
 
+	explicit NIdentifier(const Symbol& symbol);
+
 	virtual void print(std::ostream& os, int indent, unsigned int flags) const;
 
 	operator std::string();
@@ -33,12 +38,23 @@ public:
 };
 
 class NType: public Indentable {
+private:
+	// the type this node was last resolved to and where:
+	mutable const TypeInfo* resolvedIn;
+	mutable const juli::Type* resolved;
+protected:
+	virtual const juli::Type* resolveType(const TypeInfo& types) const
+			throw (CompilerError) = 0;
 public:
+	NType() :
+			resolvedIn(0), resolved(0) {
+	}
+
 	virtual ~NType() {
 	}
 
-	virtual const juli::Type* resolve(const TypeInfo& types) const
-			throw (CompilerError) = 0;
+	const juli::Type* resolve(const TypeInfo& types) const
+			throw (CompilerError);
 };
 
 class NBasicType: public NType {
@@ -52,7 +68,7 @@ public:
 
 	virtual void print(std::ostream& os, int indent, unsigned int flags) const;
 
-	virtual const juli::Type* resolve(const TypeInfo& types) const
+	virtual const juli::Type* resolveType(const TypeInfo& types) const
 			throw (CompilerError);
 
 };
@@ -69,7 +85,7 @@ public:
 
 	virtual void print(std::ostream& os, int indent, unsigned int flags) const;
 
-	virtual const juli::Type* resolve(const TypeInfo& types) const
+	virtual const juli::Type* resolveType(const TypeInfo& types) const
 			throw (CompilerError);
 };
 
@@ -141,6 +157,9 @@ public:
 class NVariableRef: public NAddressable {
 public:
 	std::string name;
+	Symbol symbol;
+	// of the declaration (see NameResolver):
+	int slot;
 
 	NVariableRef(NIdentifier* id);
 
@@ -275,6 +294,8 @@ public:
 	NIdentifier* name;
 	NType* type;
 	NExpression* assignmentExpr;
+	// the index of the variable in its function (see NameResolver):
+	int slot;
 
 	NVariableDeclaration(NType* type, NIdentifier* name,
 			NExpression *assignmentExpr = 0);
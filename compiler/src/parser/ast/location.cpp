@@ -0,0 +1,91 @@
+#include "location.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace juli;
+
+pthread_mutex_t juli::SourceFiles::mutex = PTHREAD_MUTEX_INITIALIZER;
+std::vector<SourceFiles::SourceFile*> juli::SourceFiles::files(1, (SourceFiles::SourceFile*) 0);
+std::vector<uint32_t> juli::SourceFiles::unused;
+
+juli::Marker::Marker(unsigned int line, unsigned int column) :
+		line(line), column(column) {
+}
+
+juli::SourceLocation::SourceLocation() :
+		file(0), start(0), end(0) {
+}
+
+juli::SourceLocation::SourceLocation(uint32_t file, uint32_t start, uint32_t end) :
+		file(file), start(start), end(end) {
+}
+
+const std::string juli::SourceLocation::getFilename() const {
+	return SourceFiles::getFilename(file);
+}
+
+Marker juli::SourceLocation::getStart() const {
+	return SourceFiles::getMarker(file, start);
+}
+
+Marker juli::SourceLocation::getEnd() const {
+	return SourceFiles::getMarker(file, end);
+}
+
+uint32_t juli::SourceFiles::add(const std::string& filename, const char* data, size_t size) {
+	SourceFile* f = new SourceFile();
+	f->filename = filename;
+	f->lines.push_back(0);
+	for (const char* p = data; (p = (const char*) memchr(p, '\n', data + size - p)); ++p) {
+		f->lines.push_back(p + 1 - data);
+	}
+
+	pthread_mutex_lock(&mutex);
+	uint32_t id;
+	if (unused.empty()) {
+		id = files.size();
+		files.push_back(f);
+	} else {
+		id = unused.back();
+		unused.pop_back();
+		files[id] = f;
+	}
+	pthread_mutex_unlock(&mutex);
+	return id;
+}
+
+void juli::SourceFiles::remove(uint32_t file) {
+	if (file == 0)
+		return;
+	pthread_mutex_lock(&mutex);
+	delete files[file];
+	files[file] = 0;
+	unused.push_back(file);
+	pthread_mutex_unlock(&mutex);
+}
+
+const std::string juli::SourceFiles::getFilename(uint32_t file) {
+	pthread_mutex_lock(&mutex);
+	std::string result = (file < files.size() && files[file]) ? files[file]->filename : "<unknown>";
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+Marker juli::SourceFiles::getMarker(uint32_t file, uint32_t offset) {
+	Marker result(0, 0);
+	pthread_mutex_lock(&mutex);
+	if (file < files.size() && files[file]) {
+		const std::vector<uint32_t>& lines = files[file]->lines;
+		// the last line starting at or before offset:
+		std::vector<uint32_t>::const_iterator line = std::upper_bound(lines.begin(), lines.end(), offset) - 1;
+		result = Marker(line - lines.begin() + 1, offset - *line + 1);
+	}
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const juli::Marker& marker) {
+	os << marker.line << ":" << marker.column;
+	return os;
+}
@@ -0,0 +1,81 @@
+/*
+ * location.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LOCATION_H_
+#define LOCATION_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+
+namespace juli {
+
+class Marker {
+public:
+	unsigned int line;
+	unsigned int column;
+
+	Marker(unsigned int line, unsigned int column);
+};
+
+/*
+ * Where a node is in the source: the id of the file (see SourceFiles, 0 if unknown) and the byte offsets
+ * of its first and behind its last character. Lines and columns are only computed for diagnostics.
+ */
+class SourceLocation {
+public:
+	uint32_t file;
+	uint32_t start;
+	uint32_t end;
+
+	SourceLocation();
+
+	SourceLocation(uint32_t file, uint32_t start, uint32_t end);
+
+	const std::string getFilename() const;
+
+	Marker getStart() const;
+
+	Marker getEnd() const;
+};
+
+/*
+ * The parsed source files of the process, so nodes only need to store a file id. Each file remembers
+ * where its lines start, as the file may change after it was parsed.
+ *
+ * Files are added by the parser and removed with the ast arena they were parsed into.
+ */
+class SourceFiles {
+private:
+	class SourceFile {
+	public:
+		std::string filename;
+		std::vector<uint32_t> lines;
+	};
+
+	static pthread_mutex_t mutex;
+	static std::vector<SourceFile*> files;
+	static std::vector<uint32_t> unused;
+public:
+	/*
+	 * Returns the id of the file with the given contents.
+	 */
+	static uint32_t add(const std::string& filename, const char* data, size_t size);
+
+	static void remove(uint32_t file);
+
+	static const std::string getFilename(uint32_t file);
+
+	static Marker getMarker(uint32_t file, uint32_t offset);
+};
+
+}
+
+std::ostream& operator<<(std::ostream& os, const juli::Marker& marker);
+
+#endif /* LOCATION_H_ */
@@ -4,29 +4,26 @@
 
 using namespace juli;
 
-juli::Marker::Marker(unsigned int line, unsigned int column) :
-		line(line), column(column) {
+juli::Indentable::Indentable() {
 }
 
-juli::Marker::~Marker() {
+juli::Indentable::~Indentable() {
 }
 
-void juli::Marker::print(std::ostream& os) const {
-	os << line << ":" << column;
+void juli::Indentable::setSourceLocation(const SourceLocation& location) {
+	this->location = location;
 }
 
-juli::Indentable::Indentable() :
-		filename("<unknown>"), start(0, 0), end(0, 0) {
+const std::string juli::Indentable::getFilename() const {
+	return location.getFilename();
 }
 
-juli::Indentable::~Indentable() {
+Marker juli::Indentable::getStart() const {
+	return location.getStart();
 }
 
-void juli::Indentable::setSourceLocation(const std::string& filename,
-		const Marker& start, const Marker& end) {
-	this->filename = filename;
-	this->start = start;
-	this->end = end;
+Marker juli::Indentable::getEnd() const {
+	return location.getEnd();
 }
 
 void juli::Indentable::print(std::ostream& os) const {
@@ -38,7 +35,7 @@ void juli::Indentable::beginLine(std::ostream& os, int indent) const {
 }
 
 void juli::Indentable::printLocation(std::ostream& os) const {
-	os << "  (" << filename << "  " << start << " - " << end << ")"
+	os << "  (" << getFilename() << "  " << getStart() << " - " << getEnd() << ")"
 			<< std::endl;
 }
 
@@ -9,6 +9,8 @@
 
 #include <debug/print.h>
 
+#include <parser/ast/location.h>
+
 namespace juli {
 
 enum Operator {
@@ -71,34 +73,32 @@ enum NodeType {
 	IMPORT
 };
 
-class Marker : public cpputils::debug::Printable {
-public:
-	unsigned int line;
-	unsigned int column;
-
-	Marker(unsigned int line, unsigned int column);
-
-	virtual ~Marker();
-
-	virtual void print(std::ostream& os) const;
-};
-
 class Indentable : public cpputils::debug::Printable {
 public:
-	std::string filename;
-	Marker start;
-	Marker end;
+	SourceLocation location;
 
 	Indentable();
 
 	virtual ~Indentable();
 
+	/*
+	 * Nodes live in the current AstArena, if there is one (see arena.h).
+	 */
+	static void* operator new(size_t size);
+
+	static void operator delete(void* p);
+
 	void beginLine(std::ostream& os, int indent) const;
 
 	void printLocation(std::ostream& os) const;
 
-	void setSourceLocation(const std::string& filename,
-			const Marker& start, const Marker& end);
+	void setSourceLocation(const SourceLocation& location);
+
+	const std::string getFilename() const;
+
+	Marker getStart() const;
+
+	Marker getEnd() const;
 
 	virtual void print(std::ostream& os, int indent,
 			unsigned int flags) const = 0;
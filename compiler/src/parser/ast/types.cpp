@@ -1,5 +1,6 @@
 #include "types.h"
 
+#include <climits>
 #include <stdexcept>
 
 using namespace juli;
@@ -94,11 +95,6 @@ bool juli::PrimitiveType::isFloatingPoint() const {
 	}
 }
 
-bool juli::PrimitiveType::operator==(const Type& t) const {
-	const PrimitiveType* pt = dynamic_cast<const PrimitiveType*>(&t);
-	return (pt != 0) ? primitive == pt->primitive : false;
-}
-
 void juli::PrimitiveType::print(std::ostream& os) const {
 	switch (primitive) {
 	case VOID:
@@ -189,10 +185,6 @@ const Field* juli::ReferenceType::getField(const std::string& name) const {
 	return 0;
 }
 
-bool juli::ReferenceType::operator==(const Type& t) const {
-	return t.getCategory() == REFERENCE;
-}
-
 const std::string juli::ReferenceType::mangle() const {
 	return "R";
 }
@@ -201,15 +193,15 @@ void juli::ReferenceType::print(std::ostream& os) const {
 	os << "ref";
 }
 
-ArrayType* juli::ArrayType::getMultiDimensionalArray(const Type* elementType,
+const ArrayType* juli::ArrayType::getMultiDimensionalArray(const Type* elementType,
 		int dimension) {
-	return new ArrayType(elementType, dimension);
+	return TypeContext::getArray(elementType, dimension);
 }
 
 juli::ArrayType::ArrayType(const Type* elementType, int dimension,
 		int staticSize) :
 		Type(ARRAY), elementType(elementType), dimension(dimension), staticSize(
-				staticSize) {
+				staticSize), length(LENGTH) {
 }
 
 juli::ArrayType::~ArrayType() {
@@ -227,14 +219,6 @@ int juli::ArrayType::getStaticSize() const {
 	return staticSize;
 }
 
-bool juli::ArrayType::operator==(const Type& t) const {
-	const ArrayType* pt = dynamic_cast<const ArrayType*>(&t);
-	if (!pt)
-		return false;
-	return (*elementType == *pt->elementType && dimension == pt->dimension
-			&& staticSize == pt->staticSize);
-}
-
 void juli::ArrayType::print(std::ostream& os) const {
 	if (dimension == 1) {
 		if (staticSize >= 0)
@@ -260,11 +244,7 @@ bool juli::ArrayType::canCastTo(const Type* t) const {
 
 const Field* juli::ArrayType::getField(const std::string& name) const {
 	if (name == "length") {
-		if (dimension == 1)
-			return &LENGTH;
-		else
-			return new Field("length", 1,
-					new ArrayType(&PrimitiveType::INT32_TYPE, 1, dimension));
+		return &length;
 	} else {
 		return 0;
 	}
@@ -291,6 +271,10 @@ juli::ClassType::ClassType(const std::string& name,
 	addFields(fields);
 }
 
+const std::string& juli::ClassType::getName() const {
+	return name;
+}
+
 void juli::ClassType::addFields(const std::vector<Field>& fields) {
 	for (std::vector<Field>::const_iterator i = fields.begin();
 			i != fields.end(); ++i) {
@@ -299,6 +283,7 @@ void juli::ClassType::addFields(const std::vector<Field>& fields) {
 }
 
 juli::ClassType::~ClassType() {
+	TypeContext::release(this);
 }
 
 bool juli::ClassType::isAssignableTo(const Type* t) const {
@@ -318,13 +303,6 @@ const Field* juli::ClassType::getField(const std::string& name) const {
 	return 0;
 }
 
-bool juli::ClassType::operator==(const Type& t) const {
-	const ClassType* ct = dynamic_cast<const ClassType*>(&t);
-	if (!ct)
-		return false;
-	return (name == ct->name);
-}
-
 const std::string juli::ClassType::mangle() const {
 	std::stringstream s;
 	s << "C" << name;
@@ -343,3 +321,42 @@ std::vector<Field> juli::ClassType::getFields() const {
 	}
 	return result;
 }
+
+pthread_mutex_t juli::TypeContext::mutex = PTHREAD_MUTEX_INITIALIZER;
+std::map<TypeContext::ArrayKey, ArrayType*> juli::TypeContext::arrays;
+
+const ArrayType* juli::TypeContext::getArrayLocked(const Type* elementType, unsigned int dimension,
+		int staticSize) {
+	ArrayType*& type = arrays[ArrayKey(elementType, std::make_pair(dimension, staticSize))];
+	if (!type) {
+		type = new ArrayType(elementType, dimension, staticSize);
+		if (dimension > 1)
+			type->length.type = getArrayLocked(&PrimitiveType::INT32_TYPE, 1, dimension);
+	}
+	return type;
+}
+
+const ArrayType* juli::TypeContext::getArray(const Type* elementType, unsigned int dimension, int staticSize) {
+	pthread_mutex_lock(&mutex);
+	const ArrayType* result = getArrayLocked(elementType, dimension, staticSize);
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+void juli::TypeContext::releaseLocked(const Type* elementType) {
+	std::map<ArrayKey, ArrayType*>::iterator i = arrays.lower_bound(
+			ArrayKey(elementType, std::make_pair(0u, INT_MIN)));
+	while (i != arrays.end() && i->first.first == elementType) {
+		ArrayType* type = i->second;
+		// the recursion only removes arrays of other element types, so i stays valid:
+		arrays.erase(i++);
+		releaseLocked(type);
+		delete type;
+	}
+}
+
+void juli::TypeContext::release(const Type* elementType) {
+	pthread_mutex_lock(&mutex);
+	releaseLocked(elementType);
+	pthread_mutex_unlock(&mutex);
+}
@@ -11,6 +11,9 @@
 #include <debug/print.h>
 #include <parser/ast/node.h>
 
+#include <map>
+#include <pthread.h>
+
 namespace juli {
 
 enum Primitive {
@@ -59,7 +62,16 @@ public:
 
 	virtual const Field* getField(const std::string& name) const = 0;
 
-	virtual bool operator==(const Type& t) const = 0;
+	/*
+	 * Every type exists only once (see TypeContext), so types are equal if they are the same object.
+	 */
+	bool operator==(const Type& t) const {
+		return this == &t;
+	}
+
+	bool operator!=(const Type& t) const {
+		return this != &t;
+	}
 
 	virtual const std::string mangle() const = 0;
 
@@ -92,8 +104,6 @@ public:
 
 	bool isFloatingPoint() const;
 
-	virtual bool operator==(const Type& t) const;
-
 	virtual void print(std::ostream& os) const;
 
 	virtual bool isAssignableTo(const Type* t) const;
@@ -122,8 +132,6 @@ public:
 
 	virtual const Field* getField(const std::string& name) const;
 
-	virtual bool operator==(const Type& t) const;
-
 	virtual const std::string mangle() const;
 
 	TypeCategory getCategory() const;
@@ -134,18 +142,23 @@ public:
 
 class ArrayType: public Type {
 private:
+	friend class TypeContext;
+
 	const Type* elementType;
 	unsigned int dimension;
 	int staticSize;
 
+	// int[dimension] for multi dimensional arrays:
+	Field length;
+
 	static const Field LENGTH;
+
+	ArrayType(const Type* elementType, int dimension, int staticSize);
 public:
 
-	static ArrayType* getMultiDimensionalArray(const Type* elementType,
+	static const ArrayType* getMultiDimensionalArray(const Type* elementType,
 			int dimension);
 
-	ArrayType(const Type* elementType, int dimension = 1, int staticSize = -1);
-
 	virtual ~ArrayType();
 
 	const Type* getElementType() const;
@@ -154,8 +167,6 @@ public:
 
 	int getStaticSize() const;
 
-	virtual bool operator==(const Type& t) const;
-
 	virtual void print(std::ostream& os) const;
 
 	virtual bool isAssignableTo(const Type* t) const;
@@ -174,6 +185,8 @@ private:
 public:
 	ClassType(const std::string& name, const std::vector<Field>& fields);
 
+	const std::string& getName() const;
+
 	void addFields(const std::vector<Field>& fields);
 
 	virtual ~ClassType();
@@ -184,8 +197,6 @@ public:
 
 	virtual const Field* getField(const std::string& name) const;
 
-	virtual bool operator==(const Type& t) const;
-
 	virtual const std::string mangle() const;
 
 	TypeCategory getCategory() const;
@@ -196,6 +207,33 @@ public:
 
 };
 
+/*
+ * Creates the structural types, each exactly once, so types can be compared by pointer. Primitive types
+ * are the PrimitiveType constants and class types are created once per definition (see TypeInfo).
+ *
+ * Interned types may be shared by concurrent compilations. Arrays of primitives live as long as the
+ * process, arrays of a class (also nested ones) as long as the class.
+ */
+class TypeContext {
+private:
+	typedef std::pair<const Type*, std::pair<unsigned int, int> > ArrayKey;
+
+	static pthread_mutex_t mutex;
+	static std::map<ArrayKey, ArrayType*> arrays;
+
+	static const ArrayType* getArrayLocked(const Type* elementType, unsigned int dimension, int staticSize);
+
+	static void releaseLocked(const Type* elementType);
+public:
+	static const ArrayType* getArray(const Type* elementType, unsigned int dimension = 1, int staticSize = -1);
+
+	/*
+	 * Deletes the arrays of the given element type and the arrays of those, called when a class is
+	 * deleted, so its address can be reused by another class.
+	 */
+	static void release(const Type* elementType);
+};
+
 }
 
 #endif /* TYPES_H_ */
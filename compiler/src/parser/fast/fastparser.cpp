@@ -0,0 +1,538 @@
+#include "fastparser.h"
+
+#include <cstdlib>
+#include <limits>
+
+using namespace juli;
+
+juli::FastParser::FastParser(const char* data, size_t size, uint32_t file) :
+		data(data), file(file), pos(0) {
+	// about one token per five bytes of typical source:
+	tokens.reserve(size / 5 + 1);
+	Lexer lexer(data, size);
+	lexer.tokenize(tokens);
+}
+
+void juli::FastParser::fail(const Token& token, const std::string& expected) const throw (Error) {
+	Error e;
+	e.getStream() << SourceFiles::getFilename(file) << "  " << SourceFiles::getMarker(file, token.start)
+			<< " - Syntax error: expected " << expected << " but found " << Lexer::getName(token.type);
+	throw e;
+}
+
+const Token& juli::FastParser::expect(TokenType type) throw (Error) {
+	const Token& token = tokens[pos];
+	if (token.type != type)
+		fail(token, Lexer::getName(type));
+	++pos;
+	return token;
+}
+
+std::string juli::FastParser::getText(const Token& token) const {
+	return std::string(data + token.start, token.end - token.start);
+}
+
+void juli::FastParser::setLocation(Indentable* node, uint32_t start, uint32_t end) const {
+	node->setSourceLocation(SourceLocation(file, start, end));
+}
+
+size_t juli::FastParser::skipType(size_t i) const {
+	if (tokens[i].type != TOKEN_IDENTIFIER)
+		return 0;
+	++i;
+	if (tokens[i].type == TOKEN_OSBR) {
+		size_t close = i + 1;
+		while (tokens[close].type == TOKEN_COMMA)
+			++close;
+		return (tokens[close].type == TOKEN_CSBR) ? close + 1 : i;
+	}
+	while (tokens[i].type == TOKEN_ARRAY_SUFFIX)
+		++i;
+	return i;
+}
+
+NBlock* juli::FastParser::parse() throw (Error) {
+	NBlock* result = new NBlock();
+	do {
+		result->addStatement(statement());
+	} while (!at(TOKEN_EOF));
+	setLocation(result, result->statements.front()->location.start, result->statements.back()->location.end);
+	return result;
+}
+
+NStatement* juli::FastParser::statement() throw (Error) {
+	switch (tokens[pos].type) {
+	case TOKEN_IMPORT:
+		return importStatement();
+	case TOKEN_STRUCT:
+		return classDefinition();
+	case TOKEN_RETURN:
+		return returnStatement();
+	case TOKEN_IF:
+		return ifStatement();
+	case TOKEN_WHILE:
+		return whileStatement();
+	case TOKEN_C:
+		return functionDefinition();
+	case TOKEN_IDENTIFIER: {
+		// a type followed by a name declares something, everything else is an expression:
+		size_t name = skipType(pos);
+		if (tokens[name].type == TOKEN_IDENTIFIER)
+			return (peek(name - pos + 1).type == TOKEN_OPAR) ? functionDefinition() : variableDefinition();
+		return assignment();
+	}
+	default:
+		return assignment();
+	}
+}
+
+NStatement* juli::FastParser::importStatement() throw (Error) {
+	const Token& import = expect(TOKEN_IMPORT);
+	NIdentifier* id = identifier();
+	const Token& scol = expect(TOKEN_SCOL);
+	NStatement* result = new NImportStatement(id);
+	setLocation(result, import.start, scol.end);
+	return result;
+}
+
+NStatement* juli::FastParser::classDefinition() throw (Error) {
+	const Token& structToken = expect(TOKEN_STRUCT);
+	NIdentifier* id = identifier();
+	expect(TOKEN_OCBR);
+	FieldList fields;
+	while (!at(TOKEN_CCBR)) {
+		NType* fieldType = type();
+		NIdentifier* name = identifier();
+		const Token& scol = expect(TOKEN_SCOL);
+		NFieldDeclaration* field = new NFieldDeclaration(fieldType, name);
+		setLocation(field, fieldType->location.start, scol.end);
+		fields.push_back(field);
+	}
+	const Token& ccbr = expect(TOKEN_CCBR);
+	NStatement* result = new NClassDefinition(id, fields);
+	setLocation(result, structToken.start, ccbr.end);
+	return result;
+}
+
+NStatement* juli::FastParser::functionDefinition() throw (Error) {
+	NFunctionSignature* signature = functionDeclaration();
+	NBlock* body = 0;
+	uint32_t end;
+	if (at(TOKEN_OCBR)) {
+		body = block();
+		end = body->location.end;
+	} else {
+		end = expect(TOKEN_SCOL).end;
+	}
+	NStatement* result = new NFunctionDefinition(signature, body);
+	setLocation(result, signature->location.start, end);
+	return result;
+}
+
+NFunctionSignature* juli::FastParser::functionDeclaration() throw (Error) {
+	bool cmod = at(TOKEN_C);
+	uint32_t start = tokens[pos].start;
+	if (cmod)
+		++pos;
+	NVariableDeclaration* sign = variableDeclaration();
+	if (!cmod)
+		start = sign->location.start;
+
+	expect(TOKEN_OPAR);
+	VariableList arguments;
+	bool varArgs = false;
+	if (!at(TOKEN_CPAR) && !at(TOKEN_COMMA)) {
+		arguments.push_back(variableDeclaration());
+		while (at(TOKEN_COMMA) && peek(1).type != TOKEN_VARARGS) {
+			++pos;
+			arguments.push_back(variableDeclaration());
+		}
+	}
+	if (at(TOKEN_COMMA)) {
+		++pos;
+		expect(TOKEN_VARARGS);
+		varArgs = true;
+	}
+	const Token& cpar = expect(TOKEN_CPAR);
+
+	NFunctionSignature* result = new NFunctionSignature(sign->type, sign->name->name, arguments, varArgs,
+			cmod ? MODIFIER_C : 0);
+	setLocation(result, start, cpar.end);
+	return result;
+}
+
+NStatement* juli::FastParser::variableDefinition() throw (Error) {
+	NType* variableType = type();
+	NIdentifier* id = identifier();
+	NExpression* value = 0;
+	if (at(TOKEN_ASSIGN)) {
+		++pos;
+		value = expression();
+	}
+	const Token& scol = expect(TOKEN_SCOL);
+	NStatement* result = new NVariableDeclaration(variableType, id, value);
+	setLocation(result, variableType->location.start, scol.end);
+	return result;
+}
+
+NVariableDeclaration* juli::FastParser::variableDeclaration() throw (Error) {
+	NType* variableType = type();
+	NIdentifier* id = identifier();
+	NVariableDeclaration* result = new NVariableDeclaration(variableType, id);
+	setLocation(result, variableType->location.start, id->location.end);
+	return result;
+}
+
+NBlock* juli::FastParser::block() throw (Error) {
+	NBlock* result = new NBlock();
+	const Token& ocbr = expect(TOKEN_OCBR);
+	while (!at(TOKEN_CCBR) && !at(TOKEN_EOF)) {
+		result->addStatement(statement());
+	}
+	const Token& ccbr = expect(TOKEN_CCBR);
+	setLocation(result, ocbr.start, ccbr.end);
+	return result;
+}
+
+NStatement* juli::FastParser::whileStatement() throw (Error) {
+	const Token& whileToken = expect(TOKEN_WHILE);
+	expect(TOKEN_OPAR);
+	NExpression* condition = expression();
+	expect(TOKEN_CPAR);
+	NBlock* body = block();
+	NStatement* result = new NWhileStatement(condition, body);
+	setLocation(result, whileToken.start, body->location.end);
+	return result;
+}
+
+NStatement* juli::FastParser::ifStatement() throw (Error) {
+	std::vector<NIfClause*> clauses;
+	clauses.push_back(ifClause());
+	clauses.front()->first = true;
+	while (at(TOKEN_ELSE)) {
+		if (peek(1).type == TOKEN_IF) {
+			++pos;
+			clauses.push_back(ifClause());
+		} else {
+			const Token& elseToken = expect(TOKEN_ELSE);
+			NBlock* body = block();
+			NIfClause* clause = new NIfClause(0, body);
+			setLocation(clause, elseToken.start, body->location.end);
+			clauses.push_back(clause);
+			break;
+		}
+	}
+	NStatement* result = new NIfStatement(clauses);
+	setLocation(result, clauses.front()->location.start, clauses.back()->location.end);
+	return result;
+}
+
+NIfClause* juli::FastParser::ifClause() throw (Error) {
+	const Token& ifToken = expect(TOKEN_IF);
+	expect(TOKEN_OPAR);
+	NExpression* condition = expression();
+	expect(TOKEN_CPAR);
+	NBlock* body = block();
+	NIfClause* result = new NIfClause(condition, body);
+	setLocation(result, ifToken.start, body->location.end);
+	return result;
+}
+
+NStatement* juli::FastParser::returnStatement() throw (Error) {
+	const Token& returnToken = expect(TOKEN_RETURN);
+	NExpression* value = at(TOKEN_SCOL) ? 0 : expression();
+	const Token& scol = expect(TOKEN_SCOL);
+	NStatement* result = new NReturnStatement(value);
+	setLocation(result, returnToken.start, scol.end);
+	return result;
+}
+
+NStatement* juli::FastParser::assignment() throw (Error) {
+	NExpression* lhs = expression();
+	NExpression* rhs = 0;
+	if (at(TOKEN_ASSIGN)) {
+		++pos;
+		rhs = expression();
+	}
+	const Token& scol = expect(TOKEN_SCOL);
+	NStatement* result;
+	if (rhs) {
+		result = new NAssignment(lhs, rhs);
+	} else {
+		result = new NExpressionStatement(lhs);
+	}
+	setLocation(result, lhs->location.start, scol.end);
+	return result;
+}
+
+NExpression* juli::FastParser::expression() throw (Error) {
+	return at(TOKEN_NEW) ? allocation() : binary(1);
+}
+
+NExpression* juli::FastParser::allocation() throw (Error) {
+	const Token& newToken = expect(TOKEN_NEW);
+	NType* allocated = type();
+	NExpression* result;
+	if (at(TOKEN_OSBR)) {
+		ExpressionList sizes;
+		const Token& csbr = indices(sizes);
+		result = new NAllocateArray(allocated, sizes);
+		setLocation(result, newToken.start, csbr.end);
+	} else {
+		NBasicType* basic = dynamic_cast<NBasicType*>(allocated);
+		if (!basic)
+			fail(tokens[pos], Lexer::getName(TOKEN_OSBR));
+		result = new NAllocateObject(basic);
+		setLocation(result, newToken.start, basic->location.end);
+	}
+	return result;
+}
+
+// the precedence of a binary operator, higher binds stronger, 0 if the token is none:
+static int getPrecedence(TokenType type, Operator& op) {
+	switch (type) {
+	case TOKEN_AND:
+		op = LAND;
+		return 1;
+	case TOKEN_OR:
+		op = LOR;
+		return 1;
+	case TOKEN_EQ:
+		op = EQ;
+		return 2;
+	case TOKEN_NEQ:
+		op = NEQ;
+		return 2;
+	case TOKEN_LT:
+		op = LT;
+		return 2;
+	case TOKEN_GT:
+		op = GT;
+		return 2;
+	case TOKEN_LEQ:
+		op = LEQ;
+		return 2;
+	case TOKEN_GEQ:
+		op = GEQ;
+		return 2;
+	case TOKEN_PLUS:
+		op = PLUS;
+		return 3;
+	case TOKEN_MINUS:
+		op = SUB;
+		return 3;
+	case TOKEN_MUL:
+		op = MUL;
+		return 4;
+	case TOKEN_DIV:
+		op = DIV;
+		return 4;
+	case TOKEN_MOD:
+		op = MOD;
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+NExpression* juli::FastParser::binary(int precedence) throw (Error) {
+	NExpression* result = unary();
+	Operator op;
+	int opPrecedence;
+	// all operators are left associative:
+	while ((opPrecedence = getPrecedence(tokens[pos].type, op)) >= precedence) {
+		++pos;
+		NExpression* rhs = binary(opPrecedence + 1);
+		NExpression* lhs = result;
+		result = new NBinaryOperator(lhs, op, rhs);
+		setLocation(result, lhs->location.start, rhs->location.end);
+	}
+	return result;
+}
+
+NExpression* juli::FastParser::unary() throw (Error) {
+	NUnaryOperator* current = 0;
+	while (true) {
+		Operator op;
+		switch (tokens[pos].type) {
+		case TOKEN_NOT:
+			op = NOT;
+			break;
+		case TOKEN_TILDE:
+			op = TILDE;
+			break;
+		case TOKEN_HASH:
+			op = HASH;
+			break;
+		case TOKEN_MINUS:
+			op = MINUS;
+			break;
+		default:
+			op = UNKNOWN;
+		}
+		if (op == UNKNOWN)
+			break;
+		const Token& token = tokens[pos++];
+		NUnaryOperator* uop = new NUnaryOperator(0, op);
+		setLocation(uop, token.start, token.end);
+		if (current) {
+			current->expression = uop;
+			setLocation(current, current->location.start, token.end);
+		}
+		current = uop;
+	}
+
+	NExpression* operand = qualifiedAccess();
+	if (!current)
+		return operand;
+	// like the generated parser, the innermost operator is the result:
+	current->expression = operand;
+	setLocation(current, current->location.start, operand->location.end);
+	return current;
+}
+
+NExpression* juli::FastParser::qualifiedAccess() throw (Error) {
+	NExpression* first = arrayAccess(term());
+	NExpression* result = first;
+	while (at(TOKEN_DOT)) {
+		++pos;
+		NExpression* member = arrayAccess(new NVariableRef(identifier()));
+		NArrayAccess* aa = dynamic_cast<NArrayAccess*>(member);
+		if (aa) {
+			aa->ref = new NQualifiedAccess(result, dynamic_cast<NVariableRef*>(aa->ref));
+			result = aa;
+		} else {
+			result = new NQualifiedAccess(result, dynamic_cast<NVariableRef*>(member));
+		}
+		setLocation(result, first->location.start, member->location.end);
+	}
+	return result;
+}
+
+NExpression* juli::FastParser::arrayAccess(NExpression* ref) throw (Error) {
+	NExpression* result = ref;
+	while (at(TOKEN_OSBR)) {
+		ExpressionList list;
+		const Token& csbr = indices(list);
+		result = new NArrayAccess(result, list);
+		setLocation(result, ref->location.start, csbr.end);
+	}
+	return result;
+}
+
+const Token& juli::FastParser::indices(ExpressionList& indices) throw (Error) {
+	expect(TOKEN_OSBR);
+	indices.push_back(expression());
+	while (at(TOKEN_COMMA)) {
+		++pos;
+		indices.push_back(expression());
+	}
+	return expect(TOKEN_CSBR);
+}
+
+NExpression* juli::FastParser::term() throw (Error) {
+	switch (tokens[pos].type) {
+	case TOKEN_IDENTIFIER:
+		if (peek(1).type == TOKEN_OPAR)
+			return functionCall();
+		return new NVariableRef(identifier());
+	case TOKEN_OPAR: {
+		const Token& opar = tokens[pos++];
+		NExpression* result = expression();
+		const Token& cpar = expect(TOKEN_CPAR);
+		setLocation(result, opar.start, cpar.end);
+		return result;
+	}
+	default:
+		return literal();
+	}
+}
+
+NExpression* juli::FastParser::literal() throw (Error) {
+	const Token& token = tokens[pos];
+	NExpression* result;
+	switch (token.type) {
+	case TOKEN_FLOAT: {
+		double value = strtod(getText(token).c_str(), 0);
+		result = new NLiteral<double>(DOUBLE_LITERAL, value, &PrimitiveType::FLOAT64_TYPE);
+		break;
+	}
+	case TOKEN_STRING:
+		result = new NStringLiteral(std::string(data + token.start + 1, token.end - token.start - 2));
+		break;
+	case TOKEN_CHAR:
+		result = new NCharLiteral(std::string(data + token.start + 1, token.end - token.start - 2));
+		break;
+	case TOKEN_TRUE:
+	case TOKEN_FALSE:
+		result = new NLiteral<bool>(BOOLEAN_LITERAL, token.type == TOKEN_TRUE, &PrimitiveType::BOOLEAN_TYPE);
+		break;
+	case TOKEN_NULL:
+		result = new NLiteral<int>(NULL_LITERAL, 0, &PrimitiveType::NULL_TYPE);
+		break;
+	case TOKEN_DECIMAL: {
+		// saturates like reading the literal from a stream:
+		uint64_t value = 0;
+		for (uint32_t i = token.start; i < token.end && data[i] >= '0' && data[i] <= '9'; ++i) {
+			uint64_t digit = data[i] - '0';
+			if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+				value = std::numeric_limits<uint64_t>::max();
+				break;
+			}
+			value = value * 10 + digit;
+		}
+		result = new NLiteral<uint64_t>(INTEGER_LITERAL, value, &PrimitiveType::INT32_TYPE);
+		break;
+	}
+	default:
+		fail(token, "expression");
+		return 0;
+	}
+	setLocation(result, token.start, token.end);
+	++pos;
+	return result;
+}
+
+NExpression* juli::FastParser::functionCall() throw (Error) {
+	NIdentifier* id = identifier();
+	expect(TOKEN_OPAR);
+	ExpressionList arguments;
+	if (!at(TOKEN_CPAR) && !at(TOKEN_COMMA))
+		arguments.push_back(expression());
+	while (at(TOKEN_COMMA)) {
+		++pos;
+		arguments.push_back(expression());
+	}
+	const Token& cpar = expect(TOKEN_CPAR);
+	NExpression* result = new NFunctionCall(id, arguments);
+	setLocation(result, id->location.start, cpar.end);
+	return result;
+}
+
+NType* juli::FastParser::type() throw (Error) {
+	NType* basic = new NBasicType(identifier());
+	NType* result = basic;
+	size_t end = skipType(pos - 1);
+	if (at(TOKEN_OSBR)) {
+		// basic '[' ','* ']', anything else after the '[' is not part of the type:
+		if (end > pos) {
+			result = new NArrayType(basic, end - pos - 1);
+			setLocation(result, basic->location.start, tokens[end - 1].end);
+			pos = end;
+		}
+	} else {
+		while (at(TOKEN_ARRAY_SUFFIX)) {
+			const Token& suffix = tokens[pos++];
+			result = new NArrayType(result);
+			setLocation(result, basic->location.start, suffix.end);
+		}
+	}
+	return result;
+}
+
+NIdentifier* juli::FastParser::identifier() throw (Error) {
+	const Token& token = expect(TOKEN_IDENTIFIER);
+	NIdentifier* result = new NIdentifier(getText(token));
+	setLocation(result, token.start, token.end);
+	return result;
+}
@@ -0,0 +1,94 @@
+/*
+ * fastparser.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FASTPARSER_H_
+#define FASTPARSER_H_
+
+#include <string>
+#include <vector>
+
+#include <parser/ast/ast.h>
+#include <parser/fast/lexer.h>
+#include <analysis/error.h>
+
+namespace juli {
+
+/*
+ * A hand-written parser for JL.g: recursive descent for statements and precedence climbing for binary
+ * operators. It builds the same ast as the generated parser, including the source locations, so
+ * the -ast dumps of both are identical (see --parser=compare).
+ */
+class FastParser {
+private:
+	const char* data;
+	uint32_t file;
+	std::vector<Token> tokens;
+	size_t pos;
+
+	const Token& peek(size_t ahead = 0) const {
+		size_t i = pos + ahead;
+		return tokens[(i < tokens.size()) ? i : tokens.size() - 1];
+	}
+
+	bool at(TokenType type) const {
+		return tokens[pos].type == type;
+	}
+
+	const Token& expect(TokenType type) throw (Error);
+
+	void fail(const Token& token, const std::string& expected) const throw (Error);
+
+	std::string getText(const Token& token) const;
+
+	void setLocation(Indentable* node, uint32_t start, uint32_t end) const;
+
+	// the end of the type starting at the given token, or 0 if there is none:
+	size_t skipType(size_t i) const;
+
+	NStatement* statement() throw (Error);
+	NStatement* importStatement() throw (Error);
+	NStatement* classDefinition() throw (Error);
+	NStatement* functionDefinition() throw (Error);
+	NFunctionSignature* functionDeclaration() throw (Error);
+	NStatement* variableDefinition() throw (Error);
+	NVariableDeclaration* variableDeclaration() throw (Error);
+	NBlock* block() throw (Error);
+	NStatement* whileStatement() throw (Error);
+	NStatement* ifStatement() throw (Error);
+	NIfClause* ifClause() throw (Error);
+	NStatement* returnStatement() throw (Error);
+	NStatement* assignment() throw (Error);
+
+	NExpression* expression() throw (Error);
+	NExpression* allocation() throw (Error);
+	NExpression* binary(int precedence) throw (Error);
+	NExpression* unary() throw (Error);
+	NExpression* qualifiedAccess() throw (Error);
+	NExpression* arrayAccess(NExpression* ref) throw (Error);
+	NExpression* term() throw (Error);
+	NExpression* literal() throw (Error);
+	NExpression* functionCall() throw (Error);
+
+	// '[' expression (',' expression)* ']', returns the ']':
+	const Token& indices(ExpressionList& indices) throw (Error);
+
+	NType* type() throw (Error);
+	NIdentifier* identifier() throw (Error);
+
+	FastParser(const FastParser& copy);
+	void operator=(const FastParser& copy);
+public:
+	/*
+	 * The data is only read while parsing, the ast copies everything it keeps.
+	 */
+	FastParser(const char* data, size_t size, uint32_t file);
+
+	NBlock* parse() throw (Error);
+};
+
+}
+
+#endif /* FASTPARSER_H_ */
@@ -0,0 +1,381 @@
+#include "lexer.h"
+
+#include <cstring>
+
+using namespace juli;
+
+static const char* const tokenNames[] = { "end of file", "invalid character", "identifier", "integer literal",
+		"hex literal", "octal literal", "floating point literal", "character literal", "string literal", "'+'",
+		"'-'", "'*'", "'/'", "'%'", "'=='", "'!='", "'<'", "'>'", "'<='", "'>='", "'or'", "'and'", "'not'", "'~'",
+		"'#'", "'return'", "'import'", "'if'", "'else'", "'while'", "'new'", "'true'", "'false'", "'null'",
+		"'struct'", "'C'", "'[]'", "'('", "')'", "'['", "']'", "'{'", "'}'", "';'", "','", "'='", "'.'", "'...'" };
+
+struct Keyword {
+	const char* text;
+	size_t length;
+	TokenType type;
+};
+
+static const Keyword keywords[] = { { "or", 2, TOKEN_OR }, { "and", 3, TOKEN_AND }, { "not", 3, TOKEN_NOT }, {
+		"return", 6, TOKEN_RETURN }, { "import", 6, TOKEN_IMPORT }, { "if", 2, TOKEN_IF }, { "else", 4, TOKEN_ELSE }, {
+		"while", 5, TOKEN_WHILE }, { "new", 3, TOKEN_NEW }, { "true", 4, TOKEN_TRUE }, { "false", 5, TOKEN_FALSE }, {
+		"null", 4, TOKEN_NULL }, { "struct", 6, TOKEN_STRUCT }, { "C", 1, TOKEN_C } };
+
+// the Letter and JavaIDDigit ranges of JL.g beyond ASCII:
+static const uint32_t letterRanges[][2] = { { 0x00c0, 0x00d6 }, { 0x00d8, 0x00f6 }, { 0x00f8, 0x00ff },
+		{ 0x0100, 0x1fff }, { 0x3040, 0x318f }, { 0x3300, 0x337f }, { 0x3400, 0x3d2d }, { 0x4e00, 0x9fff }, {
+				0xf900, 0xfaff } };
+
+static const uint32_t digitRanges[][2] = { { 0x0660, 0x0669 }, { 0x06f0, 0x06f9 }, { 0x0966, 0x096f }, { 0x09e6,
+		0x09ef }, { 0x0a66, 0x0a6f }, { 0x0ae6, 0x0aef }, { 0x0b66, 0x0b6f }, { 0x0be7, 0x0bef }, { 0x0c66, 0x0c6f }, {
+		0x0ce6, 0x0cef }, { 0x0d66, 0x0d6f }, { 0x0e50, 0x0e59 }, { 0x0ed0, 0x0ed9 }, { 0x1040, 0x1049 } };
+
+static bool inRanges(uint32_t c, const uint32_t ranges[][2], size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		if (c >= ranges[i][0] && c <= ranges[i][1])
+			return true;
+	}
+	return false;
+}
+
+static bool isLetter(uint32_t c) {
+	if (c < 0x80)
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+	return inRanges(c, letterRanges, sizeof(letterRanges) / sizeof(letterRanges[0]));
+}
+
+static bool isIdentifierPart(uint32_t c) {
+	if (c < 0x80)
+		return isLetter(c) || (c >= '0' && c <= '9');
+	return isLetter(c) || inRanges(c, digitRanges, sizeof(digitRanges) / sizeof(digitRanges[0]));
+}
+
+static bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static bool isOctalDigit(char c) {
+	return c >= '0' && c <= '7';
+}
+
+static bool isHexDigit(char c) {
+	return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+juli::Lexer::Lexer(const char* data, size_t size) :
+		data(data), size(size), pos(0) {
+}
+
+const char* juli::Lexer::getName(TokenType type) {
+	return tokenNames[type];
+}
+
+uint32_t juli::Lexer::peekCodePoint(uint32_t& length) const {
+	unsigned char c = data[pos];
+	if (c < 0x80) {
+		length = 1;
+		return c;
+	}
+	uint32_t codePoint;
+	if ((c & 0xe0) == 0xc0) {
+		length = 2;
+		codePoint = c & 0x1f;
+	} else if ((c & 0xf0) == 0xe0) {
+		length = 3;
+		codePoint = c & 0x0f;
+	} else if ((c & 0xf8) == 0xf0) {
+		length = 4;
+		codePoint = c & 0x07;
+	} else {
+		length = 0;
+		return 0;
+	}
+	if (pos + length > size) {
+		length = 0;
+		return 0;
+	}
+	for (uint32_t i = 1; i < length; ++i) {
+		unsigned char next = data[pos + i];
+		if ((next & 0xc0) != 0x80) {
+			length = 0;
+			return 0;
+		}
+		codePoint = (codePoint << 6) | (next & 0x3f);
+	}
+	return codePoint;
+}
+
+bool juli::Lexer::skipHidden() {
+	while (pos < size) {
+		char c = data[pos];
+		if (c == ' ' || c == '\r' || c == '\t' || c == '\f' || c == '\n') {
+			++pos;
+		} else if (c == '/' && pos + 1 < size && data[pos + 1] == '*') {
+			const char* end = 0;
+			for (uint32_t i = pos + 2; i + 1 < size; ++i) {
+				if (data[i] == '*' && data[i + 1] == '/') {
+					end = data + i + 2;
+					break;
+				}
+			}
+			if (!end)
+				return false;
+			pos = end - data;
+		} else if (c == '/' && pos + 1 < size && data[pos + 1] == '/') {
+			const char* end = (const char*) memchr(data + pos, '\n', size - pos);
+			pos = end ? end - data + 1 : size;
+		} else {
+			break;
+		}
+	}
+	return true;
+}
+
+TokenType juli::Lexer::scanNumber() {
+	uint32_t start = pos;
+	bool fraction = false;
+	if (data[pos] == '0' && pos + 2 < size && (data[pos + 1] == 'x' || data[pos + 1] == 'X')
+			&& isHexDigit(data[pos + 2])) {
+		pos += 2;
+		while (pos < size && isHexDigit(data[pos]))
+			++pos;
+		if (pos < size && (data[pos] == 'l' || data[pos] == 'L'))
+			++pos;
+		return TOKEN_HEX;
+	}
+
+	while (pos < size && isDigit(data[pos]))
+		++pos;
+	// but not the start of '...':
+	if (pos < size && data[pos] == '.' && !(pos + 2 < size && data[pos + 1] == '.' && data[pos + 2] == '.')) {
+		fraction = true;
+		++pos;
+		while (pos < size && isDigit(data[pos]))
+			++pos;
+	}
+
+	bool exponent = false;
+	if (pos < size && (data[pos] == 'e' || data[pos] == 'E')) {
+		uint32_t digits = pos + 1;
+		if (digits < size && (data[digits] == '+' || data[digits] == '-'))
+			++digits;
+		if (digits < size && isDigit(data[digits])) {
+			exponent = true;
+			pos = digits;
+			while (pos < size && isDigit(data[pos]))
+				++pos;
+		}
+	}
+
+	bool suffix = pos < size && (data[pos] == 'f' || data[pos] == 'F' || data[pos] == 'd' || data[pos] == 'D');
+	if (fraction || exponent || suffix) {
+		if (suffix)
+			++pos;
+		return TOKEN_FLOAT;
+	}
+
+	TokenType type = TOKEN_DECIMAL;
+	if (data[start] == '0' && pos - start > 1) {
+		// a leading zero takes only the octal digits:
+		pos = start + 1;
+		while (pos < size && isOctalDigit(data[pos]))
+			++pos;
+		if (pos > start + 1)
+			type = TOKEN_OCTAL;
+	}
+	if (pos < size && (data[pos] == 'l' || data[pos] == 'L'))
+		++pos;
+	return type;
+}
+
+TokenType juli::Lexer::scanIdentifier() {
+	uint32_t start = pos;
+	uint32_t length;
+	if (!isLetter(peekCodePoint(length)) || length == 0)
+		return TOKEN_ERROR;
+	pos += length;
+	while (pos < size) {
+		uint32_t c = peekCodePoint(length);
+		if (length == 0 || !isIdentifierPart(c))
+			break;
+		pos += length;
+	}
+
+	size_t textLength = pos - start;
+	for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); ++i) {
+		if (keywords[i].length == textLength && memcmp(keywords[i].text, data + start, textLength) == 0)
+			return keywords[i].type;
+	}
+	return TOKEN_IDENTIFIER;
+}
+
+bool juli::Lexer::scanEscape() {
+	if (pos + 1 >= size)
+		return false;
+	char c = data[pos + 1];
+	if (c && strchr("btnfr\"'\\", c)) {
+		pos += 2;
+		return true;
+	}
+	if (c == 'u') {
+		if (pos + 6 > size)
+			return false;
+		for (uint32_t i = pos + 2; i < pos + 6; ++i) {
+			if (!isHexDigit(data[i]))
+				return false;
+		}
+		pos += 6;
+		return true;
+	}
+	if (isOctalDigit(c)) {
+		// up to three digits, the first of three at most '3':
+		uint32_t max = (c <= '3') ? 3 : 2;
+		uint32_t digits = 1;
+		while (digits < max && pos + 1 + digits < size && isOctalDigit(data[pos + 1 + digits]))
+			++digits;
+		pos += 1 + digits;
+		return true;
+	}
+	return false;
+}
+
+TokenType juli::Lexer::scanQuoted(char quote, TokenType type) {
+	++pos;
+	bool single = type == TOKEN_CHAR;
+	uint32_t count = 0;
+	while (pos < size && data[pos] != quote) {
+		if (single && count == 1)
+			return TOKEN_ERROR;
+		if (data[pos] == '\\') {
+			if (!scanEscape())
+				return TOKEN_ERROR;
+		} else {
+			uint32_t length;
+			peekCodePoint(length);
+			pos += (length == 0) ? 1 : length;
+		}
+		++count;
+	}
+	if (pos == size || (single && count != 1))
+		return TOKEN_ERROR;
+	++pos;
+	return type;
+}
+
+TokenType juli::Lexer::scanOperator() {
+	char c = data[pos];
+	char next = (pos + 1 < size) ? data[pos + 1] : 0;
+	TokenType type;
+	uint32_t length = 1;
+	switch (c) {
+	case '+':
+		type = TOKEN_PLUS;
+		break;
+	case '-':
+		type = TOKEN_MINUS;
+		break;
+	case '*':
+		type = TOKEN_MUL;
+		break;
+	case '/':
+		type = TOKEN_DIV;
+		break;
+	case '%':
+		type = TOKEN_MOD;
+		break;
+	case '~':
+		type = TOKEN_TILDE;
+		break;
+	case '#':
+		type = TOKEN_HASH;
+		break;
+	case '=':
+		type = (next == '=') ? TOKEN_EQ : TOKEN_ASSIGN;
+		break;
+	case '!':
+		if (next != '=')
+			return TOKEN_ERROR;
+		type = TOKEN_NEQ;
+		break;
+	case '<':
+		type = (next == '=') ? TOKEN_LEQ : TOKEN_LT;
+		break;
+	case '>':
+		type = (next == '=') ? TOKEN_GEQ : TOKEN_GT;
+		break;
+	case '[':
+		type = (next == ']') ? TOKEN_ARRAY_SUFFIX : TOKEN_OSBR;
+		break;
+	case ']':
+		type = TOKEN_CSBR;
+		break;
+	case '(':
+		type = TOKEN_OPAR;
+		break;
+	case ')':
+		type = TOKEN_CPAR;
+		break;
+	case '{':
+		type = TOKEN_OCBR;
+		break;
+	case '}':
+		type = TOKEN_CCBR;
+		break;
+	case ';':
+		type = TOKEN_SCOL;
+		break;
+	case ',':
+		type = TOKEN_COMMA;
+		break;
+	case '.':
+		if (next == '.' && pos + 2 < size && data[pos + 2] == '.') {
+			type = TOKEN_VARARGS;
+			length = 3;
+		} else {
+			type = TOKEN_DOT;
+		}
+		break;
+	default:
+		return TOKEN_ERROR;
+	}
+	if (type == TOKEN_EQ || type == TOKEN_NEQ || type == TOKEN_LEQ || type == TOKEN_GEQ
+			|| type == TOKEN_ARRAY_SUFFIX)
+		length = 2;
+	pos += length;
+	return type;
+}
+
+void juli::Lexer::tokenize(std::vector<Token>& tokens) {
+	while (true) {
+		// an unterminated comment leaves pos at its start:
+		if (!skipHidden()) {
+			tokens.push_back(Token(TOKEN_ERROR, pos, size));
+			return;
+		}
+		uint32_t start = pos;
+		if (pos == size) {
+			tokens.push_back(Token(TOKEN_EOF, pos, pos));
+			return;
+		}
+
+		unsigned char c = data[pos];
+		TokenType type;
+		if (isDigit(c) || (c == '.' && pos + 1 < size && isDigit(data[pos + 1]))) {
+			type = scanNumber();
+		} else if (c == '"') {
+			type = scanQuoted('"', TOKEN_STRING);
+		} else if (c == '\'') {
+			type = scanQuoted('\'', TOKEN_CHAR);
+		} else if (c >= 0x80 || isLetter(c)) {
+			type = scanIdentifier();
+		} else {
+			type = scanOperator();
+		}
+
+		if (type == TOKEN_ERROR) {
+			tokens.push_back(Token(TOKEN_ERROR, start, start + 1));
+			return;
+		}
+		tokens.push_back(Token(type, start, pos));
+	}
+}
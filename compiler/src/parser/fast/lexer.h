@@ -0,0 +1,118 @@
+/*
+ * lexer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LEXER_H_
+#define LEXER_H_
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace juli {
+
+enum TokenType {
+	TOKEN_EOF,
+	TOKEN_ERROR,
+	TOKEN_IDENTIFIER,
+	TOKEN_DECIMAL,
+	TOKEN_HEX,
+	TOKEN_OCTAL,
+	TOKEN_FLOAT,
+	TOKEN_CHAR,
+	TOKEN_STRING,
+	TOKEN_PLUS,
+	TOKEN_MINUS,
+	TOKEN_MUL,
+	TOKEN_DIV,
+	TOKEN_MOD,
+	TOKEN_EQ,
+	TOKEN_NEQ,
+	TOKEN_LT,
+	TOKEN_GT,
+	TOKEN_LEQ,
+	TOKEN_GEQ,
+	TOKEN_OR,
+	TOKEN_AND,
+	TOKEN_NOT,
+	TOKEN_TILDE,
+	TOKEN_HASH,
+	TOKEN_RETURN,
+	TOKEN_IMPORT,
+	TOKEN_IF,
+	TOKEN_ELSE,
+	TOKEN_WHILE,
+	TOKEN_NEW,
+	TOKEN_TRUE,
+	TOKEN_FALSE,
+	TOKEN_NULL,
+	TOKEN_STRUCT,
+	TOKEN_C,
+	TOKEN_ARRAY_SUFFIX,
+	TOKEN_OPAR,
+	TOKEN_CPAR,
+	TOKEN_OSBR,
+	TOKEN_CSBR,
+	TOKEN_OCBR,
+	TOKEN_CCBR,
+	TOKEN_SCOL,
+	TOKEN_COMMA,
+	TOKEN_ASSIGN,
+	TOKEN_DOT,
+	TOKEN_VARARGS
+};
+
+/*
+ * A token is only its type and the byte offsets of its first and behind its last character, the text
+ * is taken from the input when it is needed.
+ */
+class Token {
+public:
+	TokenType type;
+	uint32_t start;
+	uint32_t end;
+
+	Token(TokenType type, uint32_t start, uint32_t end) :
+			type(type), start(start), end(end) {
+	}
+};
+
+/*
+ * Splits the input into the tokens of JL.g, skipping whitespace and comments.
+ */
+class Lexer {
+private:
+	const char* data;
+	uint32_t size;
+	uint32_t pos;
+
+	// the code point at pos and its length in bytes (0 if the input is not valid UTF-8):
+	uint32_t peekCodePoint(uint32_t& length) const;
+
+	bool skipHidden();
+
+	TokenType scanNumber();
+	TokenType scanIdentifier();
+	bool scanEscape();
+	TokenType scanQuoted(char quote, TokenType type);
+	TokenType scanOperator();
+
+	Lexer(const Lexer& copy);
+	void operator=(const Lexer& copy);
+public:
+	Lexer(const char* data, size_t size);
+
+	/*
+	 * Appends the tokens of the whole input followed by TOKEN_EOF. The input ends early with a
+	 * TOKEN_ERROR at the first character that does not start a token.
+	 */
+	void tokenize(std::vector<Token>& tokens);
+
+	static const char* getName(TokenType type);
+};
+
+}
+
+#endif /* LEXER_H_ */
@@ -1,27 +1,42 @@
 #include "parser.h"
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
+#include <parser/ast/arena.h>
+// before the generated headers, which define the token names as macros:
+#include <parser/fast/fastparser.h>
 #include <parser/antlr/JLParser.h>
 #include <parser/antlr/JLLexer.h>
+#include <parser/antlr/antlr_utils.h>
 
 using namespace juli;
 using namespace std;
 
-pANTLR3_STRING_FACTORY Parser::strFactory;
+__thread pANTLR3_STRING_FACTORY Parser::strFactory = 0;
+
+FrontEnd Parser::frontEnd = FRONT_END_ANTLR;
 
 pANTLR3_STRING juli::Parser::getString(const char* s) {
 	return strFactory->newStr(strFactory, (pANTLR3_UINT8) s);
 }
 
+void juli::Parser::setFrontEnd(FrontEnd frontEnd) {
+	Parser::frontEnd = frontEnd;
+}
+
+bool juli::Parser::isComparing() {
+	return frontEnd == FRONT_END_COMPARE;
+}
+
 juli::Parser::Parser() {
-	strFactory = antlr3StringFactoryNew(ANTLR3_ENC_UTF8);
 }
 
 juli::Parser::~Parser() {
-	delete strFactory;
 }
 
-NBlock* juli::Parser::parse(const string& filename) {
+NBlock* juli::Parser::parseAntlr(const string& filename) {
 	pANTLR3_INPUT_STREAM input;
 	pANTLR3_COMMON_TOKEN_STREAM tokenStream;
 	pJLParser parser;
@@ -54,7 +69,18 @@ NBlock* juli::Parser::parse(const string& filename) {
 		return 0;
 	}
 
-	NBlock* ast = parser->translation_unit(parser, filename);
+	// the file lives as long as the ast:
+	uint32_t file = SourceFiles::add(filename, (const char*) input->data, input->sizeBuf);
+	if (AstArena* arena = AstArena::getCurrent())
+		arena->addFile(file);
+	setSourceInput(input);
+
+	// make a factory for this parse the current one for the grammar actions:
+	pANTLR3_STRING_FACTORY outerFactory = strFactory;
+	strFactory = antlr3StringFactoryNew(ANTLR3_ENC_UTF8);
+	NBlock* ast = parser->translation_unit(parser, file);
+	strFactory->close(strFactory);
+	strFactory = outerFactory;
 
 	parser->free(parser);
 	parser = NULL;
@@ -67,3 +93,66 @@ NBlock* juli::Parser::parse(const string& filename) {
 
 	return ast;
 }
+
+NBlock* juli::Parser::parseFast(const string& filename) {
+	std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!is) {
+		cerr << "Could not find file " << filename << std::endl;
+		return 0;
+	}
+	is.seekg(0, std::ios::end);
+	std::vector<char> data((size_t) is.tellg());
+	is.seekg(0, std::ios::beg);
+	if (!data.empty())
+		is.read(&data[0], data.size());
+	const char* begin = data.empty() ? "" : &data[0];
+
+	uint32_t file = SourceFiles::add(filename, begin, data.size());
+	if (AstArena* arena = AstArena::getCurrent())
+		arena->addFile(file);
+
+	try {
+		FastParser parser(begin, data.size(), file);
+		return parser.parse();
+	} catch (Error& e) {
+		cerr << e;
+		return 0;
+	}
+}
+
+bool juli::Parser::compare(const string& filename) {
+	NBlock* ast = parseAntlr(filename);
+	NBlock* fastAst = parseFast(filename);
+	if (!ast || !fastAst) {
+		if (!ast && !fastAst)
+			return true;
+		cerr << filename << ": only the " << (ast ? "antlr" : "fast") << " parser accepts the file" << std::endl;
+		return false;
+	}
+
+	// both files have the same lines, so the dumps only differ if the asts do:
+	std::stringstream expected, actual;
+	ast->print(expected, 0, Indentable::FLAG_TREE);
+	fastAst->print(actual, 0, Indentable::FLAG_TREE);
+	std::string expectedLine, actualLine;
+	for (int line = 1; expected || actual; ++line) {
+		std::getline(expected, expectedLine);
+		std::getline(actual, actualLine);
+		if (expectedLine != actualLine || bool(expected) != bool(actual)) {
+			cerr << filename << ": the parsers disagree in line " << line << " of the ast:" << std::endl;
+			cerr << "  antlr: " << (expected ? expectedLine : "<end>") << std::endl;
+			cerr << "  fast:  " << (actual ? actualLine : "<end>") << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+NBlock* juli::Parser::parse(const string& filename) {
+	switch (frontEnd) {
+	case FRONT_END_FAST:
+		return parseFast(filename);
+	default:
+		return parseAntlr(filename);
+	}
+}
@@ -16,9 +16,30 @@ using std::string;
 
 namespace juli {
 
+enum FrontEnd {
+	// the parser generated from JL.g:
+	FRONT_END_ANTLR,
+	// the hand-written parser (see FastParser):
+	FRONT_END_FAST,
+	// both, only to compare their asts (see Parser::compare):
+	FRONT_END_COMPARE
+};
+
 class Parser {
 private:
-	static pANTLR3_STRING_FACTORY strFactory;
+	// set once before compiling, shared by all parsers:
+	static FrontEnd frontEnd;
+
+	// the factory of the parse in progress, used by the grammar actions through getString. Each parse
+	// has its own, so the strings are released with it:
+	static __thread pANTLR3_STRING_FACTORY strFactory;
+
+	NBlock* parseAntlr(const string& filename);
+
+	NBlock* parseFast(const string& filename);
+
+	Parser(const Parser& copy);
+	void operator=(const Parser& copy);
 public:
 
 	Parser();
@@ -27,6 +48,22 @@ public:
 
 	static pANTLR3_STRING getString(const char* s);
 
+	static void setFrontEnd(FrontEnd frontEnd);
+
+	/*
+	 * Whether the files are only parsed with both front ends and compared, instead of compiled.
+	 */
+	static bool isComparing();
+
+	/*
+	 * Parses the file with both front ends and returns whether they agree: both reject the file or
+	 * both produce the same -ast dump. The differences are written to cerr.
+	 */
+	bool compare(const string& filename);
+
+	/*
+	 * Parses the file with the antlr or the fast front end. Returns 0 if the file cannot be parsed.
+	 */
 	NBlock* parse(const string& filename);
 
 };
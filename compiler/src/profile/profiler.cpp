@@ -0,0 +1,209 @@
+#include "profiler.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using namespace juli;
+
+/*
+ * Heap allocations of the current thread, counted by the global operator new while a profiler exists
+ * (set before and cleared after the compiler threads run), so other runs only pay for the check.
+ */
+static bool countAllocations = false;
+static __thread uint64_t threadAllocations = 0;
+static __thread uint64_t threadAllocatedBytes = 0;
+
+static pthread_mutex_t threadIdMutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int nextThreadId = 0;
+static __thread unsigned int threadId = 0;
+
+static unsigned int getThreadId() {
+	if (threadId == 0) {
+		pthread_mutex_lock(&threadIdMutex);
+		threadId = ++nextThreadId;
+		pthread_mutex_unlock(&threadIdMutex);
+	}
+	return threadId;
+}
+
+static void* allocate(size_t size) {
+	if (countAllocations) {
+		++threadAllocations;
+		threadAllocatedBytes += size;
+	}
+	// like the default operator new, let the new handler free memory until the allocation succeeds:
+	void* p;
+	while (!(p = malloc(size ? size : 1))) {
+		std::new_handler handler = std::set_new_handler(0);
+		std::set_new_handler(handler);
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+	return p;
+}
+
+void* operator new(size_t size) throw (std::bad_alloc) {
+	return allocate(size);
+}
+
+void* operator new[](size_t size) throw (std::bad_alloc) {
+	return allocate(size);
+}
+
+void operator delete(void* p) throw () {
+	free(p);
+}
+
+void operator delete[](void* p) throw () {
+	free(p);
+}
+
+static double getWallTime() {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+juli::ProfileRecord::ProfileRecord() :
+		wall(0), cpu(0), allocations(0), allocatedBytes(0), count(0) {
+}
+
+ProfileRecord juli::ProfileRecord::now() {
+	ProfileRecord r;
+	r.wall = getWallTime();
+	struct rusage usage;
+	if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+		r.cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+				+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+	}
+	r.allocations = threadAllocations;
+	r.allocatedBytes = threadAllocatedBytes;
+	return r;
+}
+
+ProfileRecord& juli::ProfileRecord::operator+=(const ProfileRecord& other) {
+	wall += other.wall;
+	cpu += other.cpu;
+	allocations += other.allocations;
+	allocatedBytes += other.allocatedBytes;
+	count += other.count;
+	return *this;
+}
+
+ProfileRecord juli::ProfileRecord::operator-(const ProfileRecord& other) const {
+	ProfileRecord r;
+	r.wall = wall - other.wall;
+	r.cpu = cpu - other.cpu;
+	r.allocations = allocations - other.allocations;
+	r.allocatedBytes = allocatedBytes - other.allocatedBytes;
+	r.count = 1;
+	return r;
+}
+
+Profiler* juli::Profiler::instance = 0;
+
+juli::Profiler::Profiler(bool report, const std::string& traceFilename) :
+		report(report), traceFilename(traceFilename), start(getWallTime()) {
+	pthread_mutex_init(&mutex, 0);
+	instance = this;
+	countAllocations = true;
+}
+
+juli::Profiler::~Profiler() {
+	countAllocations = false;
+	instance = 0;
+	pthread_mutex_destroy(&mutex);
+}
+
+void juli::Profiler::add(const char* category, const std::string& name, const ProfileRecord& start,
+		const ProfileRecord& end, bool traceOnly) {
+	pthread_mutex_lock(&mutex);
+	if (report && !traceOnly)
+		records[category][name] += end - start;
+	if (!traceFilename.empty()) {
+		TraceEvent e;
+		e.name = name;
+		e.category = category;
+		e.start = start.wall - this->start;
+		e.duration = end.wall - start.wall;
+		e.thread = getThreadId();
+		events.push_back(e);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+void juli::Profiler::printReport(std::ostream& os) {
+	if (!report)
+		return;
+	pthread_mutex_lock(&mutex);
+	for (std::map<std::string, std::map<std::string, ProfileRecord> >::iterator i = records.begin();
+			i != records.end(); ++i) {
+		ProfileRecord total;
+		os << "===== " << i->first << " =====" << std::endl;
+		os << std::setw(12) << "wall (s)" << std::setw(12) << "cpu (s)" << std::setw(14) << "allocations"
+				<< std::setw(14) << "kbytes" << std::setw(8) << "count" << "  name" << std::endl;
+		for (std::map<std::string, ProfileRecord>::iterator j = i->second.begin(); j != i->second.end(); ++j) {
+			const ProfileRecord& r = j->second;
+			os << std::fixed << std::setprecision(4) << std::setw(12) << r.wall << std::setw(12) << r.cpu
+					<< std::setw(14) << r.allocations << std::setw(14) << (r.allocatedBytes >> 10) << std::setw(8)
+					<< r.count << "  " << j->first << std::endl;
+			total += r;
+		}
+		os << std::setw(12) << total.wall << std::setw(12) << total.cpu << std::setw(14) << total.allocations
+				<< std::setw(14) << (total.allocatedBytes >> 10) << std::setw(8) << total.count << "  total"
+				<< std::endl;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+static void writeJSONString(std::ostream& os, const std::string& s) {
+	os << '"';
+	for (std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
+		if (*i == '"' || *i == '\\')
+			os << '\\';
+		os << *i;
+	}
+	os << '"';
+}
+
+/*
+ * Chrome trace event format: complete events ("X") with timestamps in microseconds.
+ */
+void juli::Profiler::writeTrace() {
+	if (traceFilename.empty())
+		return;
+	pthread_mutex_lock(&mutex);
+	std::ofstream os(traceFilename.c_str());
+	os << "{\"traceEvents\":[";
+	for (std::vector<TraceEvent>::iterator i = events.begin(); i != events.end(); ++i) {
+		if (i != events.begin())
+			os << ",";
+		os << std::endl << "{\"name\":";
+		writeJSONString(os, i->name);
+		os << ",\"cat\":\"" << i->category << "\",\"ph\":\"X\",\"ts\":" << std::fixed << std::setprecision(1)
+				<< i->start * 1e6 << ",\"dur\":" << i->duration * 1e6 << ",\"pid\":" << getpid() << ",\"tid\":"
+				<< i->thread << "}";
+	}
+	os << std::endl << "]}" << std::endl;
+	pthread_mutex_unlock(&mutex);
+}
+
+juli::ProfileScope::ProfileScope(const char* category, const std::string& name, bool traceOnly) :
+		profiler(Profiler::get()), category(category), traceOnly(traceOnly) {
+	if (profiler) {
+		this->name = name;
+		start = ProfileRecord::now();
+	}
+}
+
+juli::ProfileScope::~ProfileScope() {
+	if (profiler)
+		profiler->add(category, name, start, ProfileRecord::now(), traceOnly);
+}
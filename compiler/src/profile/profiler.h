@@ -0,0 +1,106 @@
+/*
+ * profiler.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include <pthread.h>
+
+namespace juli {
+
+/*
+ * Wall time, CPU time of the thread and heap allocations.
+ */
+class ProfileRecord {
+public:
+	double wall;
+	double cpu;
+	uint64_t allocations;
+	uint64_t allocatedBytes;
+	unsigned int count;
+
+	ProfileRecord();
+
+	static ProfileRecord now();
+
+	ProfileRecord& operator+=(const ProfileRecord& other);
+	ProfileRecord operator-(const ProfileRecord& other) const;
+};
+
+class TraceEvent {
+public:
+	std::string name;
+	const char* category;
+	double start;
+	double duration;
+	unsigned int thread;
+};
+
+/*
+ * Collects the time spent in the phases of the compiler (-ftime-report) and spans for a Chrome trace
+ * (-ftrace, load the file in chrome://tracing). Inactive unless enabled, so instrumented code only
+ * pays for a null check.
+ */
+class Profiler {
+private:
+	static Profiler* instance;
+
+	const bool report;
+	const std::string traceFilename;
+	const double start;
+
+	pthread_mutex_t mutex;
+	std::map<std::string, std::map<std::string, ProfileRecord> > records;
+	std::vector<TraceEvent> events;
+
+	Profiler(const Profiler& copy);
+	void operator=(const Profiler& copy);
+public:
+	/*
+	 * Enables profiling for the whole process.
+	 */
+	Profiler(bool report, const std::string& traceFilename);
+	~Profiler();
+
+	static Profiler* get() {
+		return instance;
+	}
+
+	/*
+	 * Adds the record to the report (unless traceOnly) and the trace.
+	 */
+	void add(const char* category, const std::string& name, const ProfileRecord& start, const ProfileRecord& end,
+			bool traceOnly);
+
+	void printReport(std::ostream& os);
+
+	void writeTrace();
+};
+
+/*
+ * Profiles the lifetime of the scope. Categories are reported separately, e.g. "phase" for the
+ * compiler phases and "import" for imported modules (which includes the modules they import).
+ */
+class ProfileScope {
+private:
+	Profiler* profiler;
+	const char* category;
+	std::string name;
+	bool traceOnly;
+	ProfileRecord start;
+public:
+	ProfileScope(const char* category, const std::string& name, bool traceOnly = false);
+	~ProfileScope();
+};
+
+}
+
+#endif /* PROFILER_H_ */
@@ -1,6 +1,6 @@
-C int printf(char[] s, ...);
+import math;
 
-C double sqrt(double x);
+C int printf(char[] s, ...);
 
 int strlen(char[] str) 
 {